@@ -0,0 +1,30 @@
+#include "superfloat.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace aoi;
+
+// Computes N decimal digits of pi end to end: Chudnovsky binary splitting,
+// then the final division and square root, then decimal conversion
+int main(int argc, char** argv) {
+  size_t digits = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 10000;
+  // log2(10) ~ 3.3219 bits per digit, plus a few to settle the last digit
+  size_t bits = digits * 33220 / 10000 + 16;
+
+  auto start = std::chrono::steady_clock::now();
+  SuperFloat pi = SuperFloat::pi(bits);
+  auto computed = std::chrono::steady_clock::now();
+  std::string text = pi.toString(digits);
+  auto converted = std::chrono::steady_clock::now();
+
+  using Ms = std::chrono::duration<double, std::milli>;
+  std::cout << "digits:     " << digits << std::endl;
+  std::cout << "compute:    " << Ms(computed - start).count() << " ms" << std::endl;
+  std::cout << "to decimal: " << Ms(converted - computed).count() << " ms" << std::endl;
+  std::cout << "head:       " << text.substr(0, 12) << std::endl;
+  std::cout << "tail:       " << text.substr(text.size() - 10) << std::endl;
+  return 0;
+}
@@ -0,0 +1,424 @@
+#include "decimalsuperlong.hpp"
+#include "superlong-trace.hpp"
+
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+using namespace aoi;
+
+__extension__ typedef unsigned __int128 uint128;
+
+using Limb = DecimalSuperLong::Limb;
+using Limbs = std::vector<Limb>;
+
+static constexpr Limb kBase = DecimalSuperLong::kBase;
+static constexpr size_t kLimbDigits = DecimalSuperLong::kLimbDigits;
+static constexpr uint32_t kNineDigits = 1000000000;
+
+static constexpr size_t KARATSUBA_THRESHOLD = 24;
+// Leaf sizes of the conversion trees, converted by Horner's rule
+static constexpr size_t kLeafBytes = 64;
+static constexpr size_t kLeafLimbs = 8;
+
+static void trim(Limbs& value) {
+  while (value.size() > 1 && value.back() == 0) {
+    value.pop_back();
+  }
+}
+
+static int compareMagnitudes(const Limbs& a, const Limbs& b) {
+  if (a.size() != b.size()) {
+    return (a.size() < b.size()) ? -1 : 1;
+  }
+  for (size_t i = a.size(); i-- > 0;) {
+    if (a[i] != b[i]) {
+      return (a[i] < b[i]) ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+// out[0, count) += in[0, n) with the carry run out to the end of out. Two
+// limbs may sum past 2^64, so the carry is decided before adding
+static void addInPlace(Limb* out, size_t count, const Limb* in, size_t n) {
+  Limb carry = 0;
+  for (size_t i = 0; i < count && (i < n || carry != 0); i++) {
+    Limb addend = ((i < n) ? in[i] : 0) + carry;
+    if (addend == kBase) {
+      carry = 1;
+      continue;
+    }
+    if (out[i] >= kBase - addend) {
+      out[i] -= kBase - addend;
+      carry = 1;
+    } else {
+      out[i] += addend;
+      carry = 0;
+    }
+  }
+}
+
+// out[0, count) -= in[0, n); the result must not be negative
+static void subtractInPlace(Limb* out, size_t count, const Limb* in, size_t n) {
+  Limb borrow = 0;
+  for (size_t i = 0; i < count && (i < n || borrow != 0); i++) {
+    Limb subtrahend = ((i < n) ? in[i] : 0) + borrow;
+    if (out[i] < subtrahend) {
+      out[i] += kBase - subtrahend;
+      borrow = 1;
+    } else {
+      out[i] -= subtrahend;
+      borrow = 0;
+    }
+  }
+}
+
+static Limbs addMagnitudes(const Limb* a, size_t na, const Limb* b, size_t nb) {
+  if (na < nb) {
+    std::swap(a, b);
+    std::swap(na, nb);
+  }
+  Limbs result(a, a + na);
+  result.push_back(0);
+  addInPlace(result.data(), result.size(), b, nb);
+  return result;
+}
+
+static void mulAddSmall(Limbs& value, uint64_t factor, uint64_t addend) {
+  uint128 carry = addend;
+  for (Limb& limb : value) {
+    uint128 cur = static_cast<uint128>(limb) * factor + carry;
+    limb = static_cast<Limb>(cur % kBase);
+    carry = cur / kBase;
+  }
+  while (carry != 0) {
+    value.push_back(static_cast<Limb>(carry % kBase));
+    carry /= kBase;
+  }
+}
+
+// Returns the na + nb limb product without trimming
+static Limbs multiplyMagnitudes(const Limb* a, size_t na, const Limb* b, size_t nb) {
+  if (na < nb) {
+    std::swap(a, b);
+    std::swap(na, nb);
+  }
+  Limbs result(na + nb, 0);
+  if (nb < KARATSUBA_THRESHOLD) {
+    for (size_t j = 0; j < nb; j++) {
+      if (b[j] == 0) {
+        continue;
+      }
+      uint128 carry = 0;
+      for (size_t i = 0; i < na; i++) {
+        uint128 cur = static_cast<uint128>(a[i]) * b[j] + result[i + j] + carry;
+        result[i + j] = static_cast<Limb>(cur % kBase);
+        carry = cur / kBase;
+      }
+      result[j + na] = static_cast<Limb>(carry);
+    }
+    return result;
+  }
+
+  size_t m = na / 2;
+  if (nb <= m) {
+    // The shorter operand has no high half: two products of the longer
+    // operand's halves, added at their offsets
+    Limbs low = multiplyMagnitudes(a, m, b, nb);
+    Limbs high = multiplyMagnitudes(a + m, na - m, b, nb);
+    std::copy(low.begin(), low.end(), result.begin());
+    addInPlace(result.data() + m, result.size() - m, high.data(), high.size());
+    return result;
+  }
+
+  Limbs z0 = multiplyMagnitudes(a, m, b, m);
+  Limbs z2 = multiplyMagnitudes(a + m, na - m, b + m, nb - m);
+  Limbs sumA = addMagnitudes(a, m, a + m, na - m);
+  Limbs sumB = addMagnitudes(b, m, b + m, nb - m);
+  Limbs z1 = multiplyMagnitudes(sumA.data(), sumA.size(), sumB.data(), sumB.size());
+  subtractInPlace(z1.data(), z1.size(), z0.data(), z0.size());
+  subtractInPlace(z1.data(), z1.size(), z2.data(), z2.size());
+
+  std::copy(z0.begin(), z0.end(), result.begin());
+  std::copy(z2.begin(), z2.end(), result.begin() + static_cast<std::ptrdiff_t>(2 * m));
+  trim(z1);
+  addInPlace(result.data() + m, result.size() - m, z1.data(), z1.size());
+  return result;
+}
+
+static Limbs multiplyMagnitudes(const Limbs& a, const Limbs& b) {
+  Limbs result = multiplyMagnitudes(a.data(), a.size(), b.data(), b.size());
+  trim(result);
+  return result;
+}
+
+// Horner's rule over the bytes, four at a time from the top
+static Limbs decimalLeaf(const n256* bytes, size_t count) {
+  Limbs result {0};
+  size_t i = count;
+  while (i > 0) {
+    size_t take = (i % 4 == 0) ? 4 : i % 4;
+    uint64_t chunk = 0;
+    for (size_t k = 0; k < take; k++) {
+      chunk = (chunk << 8) | bytes[i - 1 - k];
+    }
+    mulAddSmall(result, uint64_t {1} << (8 * take), chunk);
+    i -= take;
+  }
+  trim(result);
+  return result;
+}
+
+// powers[j] = 256^(kLeafBytes * 2^j); the bytes fit in kLeafBytes << level
+static Limbs toDecimal(const n256* bytes, size_t count, const std::vector<Limbs>& powers, size_t level) {
+  if (level == 0) {
+    return decimalLeaf(bytes, count);
+  }
+  size_t half = kLeafBytes << (level - 1);
+  if (count <= half) {
+    return toDecimal(bytes, count, powers, level - 1);
+  }
+  Limbs low = toDecimal(bytes, half, powers, level - 1);
+  Limbs high = toDecimal(bytes + half, count - half, powers, level - 1);
+  Limbs result = multiplyMagnitudes(high, powers[level - 1]);
+  result.resize(std::max(result.size(), low.size()) + 1, 0);
+  addInPlace(result.data(), result.size(), low.data(), low.size());
+  trim(result);
+  return result;
+}
+
+static size_t treeLevels(size_t count, size_t leaf) {
+  size_t level = 0;
+  while ((leaf << level) < count) {
+    level++;
+  }
+  return level;
+}
+
+DecimalSuperLong::DecimalSuperLong() : sign(Sign::Positive), limbs(1, 0) {
+}
+
+DecimalSuperLong::DecimalSuperLong(int64_t num) : sign(num < 0 ? Sign::Negative : Sign::Positive) {
+  // |INT64_MIN| = 2^63 is below 10^19, so one limb always suffices
+  uint64_t magnitude = (num < 0) ? ~static_cast<uint64_t>(num) + 1 : static_cast<uint64_t>(num);
+  limbs.push_back(magnitude);
+}
+
+DecimalSuperLong::DecimalSuperLong(Sign sign, std::vector<Limb> limbs) : sign(sign), limbs(std::move(limbs)) {
+  removeLeadingZeros();
+}
+
+DecimalSuperLong::DecimalSuperLong(std::string_view str) : sign(Sign::Positive) {
+  if (str.empty()) {
+    throw std::invalid_argument("Input string cannot be empty");
+  }
+  size_t start = 0;
+  if (str[0] == '-' || str[0] == '+') {
+    sign = (str[0] == '-') ? Sign::Negative : Sign::Positive;
+    start = 1;
+  }
+  if (start == str.size()) {
+    throw std::invalid_argument("Input string cannot be just a sign");
+  }
+  limbs.reserve((str.size() - start) / kLimbDigits + 1);
+  for (size_t end = str.size(); end > start;) {
+    size_t begin = (end - start > kLimbDigits) ? end - kLimbDigits : start;
+    Limb limb = 0;
+    for (size_t i = begin; i < end; i++) {
+      if (str[i] < '0' || str[i] > '9') {
+        throw std::invalid_argument("Input string contains non-digit characters");
+      }
+      limb = limb * 10 + static_cast<Limb>(str[i] - '0');
+    }
+    limbs.push_back(limb);
+    end = begin;
+  }
+  removeLeadingZeros();
+}
+
+DecimalSuperLong::DecimalSuperLong(const SuperLong& value) : sign(value.sign) {
+  detail::UntracedScope untraced;
+  const n256* bytes = value.digits.data();
+  size_t count = value.digits.size();
+  size_t levels = treeLevels(count, kLeafBytes);
+
+  std::vector<Limbs> powers;
+  if (levels > 0) {
+    std::vector<n256> unit(kLeafBytes + 1, 0);
+    unit.back() = 1;
+    powers.push_back(decimalLeaf(unit.data(), unit.size()));
+    while (powers.size() < levels) {
+      powers.push_back(multiplyMagnitudes(powers.back(), powers.back()));
+    }
+  }
+  limbs = toDecimal(bytes, count, powers, levels);
+  removeLeadingZeros();
+}
+
+SuperLong DecimalSuperLong::binaryLeaf(const Limb* in, size_t count) {
+  SuperLong result;
+  for (size_t i = count; i-- > 0;) {
+    Limb limb = in[i];
+    // 10^19 = 10 * 10^9 * 10^9, each factor within mulAddSmall's range
+    result.mulAddSmall(10, static_cast<uint32_t>(limb / (uint64_t {kNineDigits} * kNineDigits)));
+    result.mulAddSmall(kNineDigits, static_cast<uint32_t>(limb / kNineDigits % kNineDigits));
+    result.mulAddSmall(kNineDigits, static_cast<uint32_t>(limb % kNineDigits));
+  }
+  return result;
+}
+
+// powers[j] = (10^19)^(kLeafLimbs * 2^j); the limbs fit in kLeafLimbs << level
+SuperLong DecimalSuperLong::toBinary(const Limb* in, size_t count, const std::vector<SuperLong>& powers,
+                                     size_t level) {
+  if (level == 0) {
+    return binaryLeaf(in, count);
+  }
+  size_t half = kLeafLimbs << (level - 1);
+  if (count <= half) {
+    return toBinary(in, count, powers, level - 1);
+  }
+  return toBinary(in + half, count - half, powers, level - 1) * powers[level - 1] +
+         toBinary(in, half, powers, level - 1);
+}
+
+SuperLong DecimalSuperLong::toSuperLong() const {
+  detail::UntracedScope untraced;
+  size_t levels = treeLevels(limbs.size(), kLeafLimbs);
+  std::vector<SuperLong> powers;
+  if (levels > 0) {
+    Limbs unit(kLeafLimbs + 1, 0);
+    unit.back() = 1;
+    powers.push_back(binaryLeaf(unit.data(), unit.size()));
+    while (powers.size() < levels) {
+      powers.push_back(powers.back() * powers.back());
+    }
+  }
+  SuperLong result = toBinary(limbs.data(), limbs.size(), powers, levels);
+  if (sign == Sign::Negative) {
+    result.negate();
+  }
+  return result;
+}
+
+std::string DecimalSuperLong::toString() const {
+  std::string result;
+  result.reserve(limbs.size() * kLimbDigits + 1);
+  if (sign == Sign::Negative) {
+    result += '-';
+  }
+  result += std::to_string(limbs.back());
+  char buffer[kLimbDigits];
+  for (size_t i = limbs.size() - 1; i-- > 0;) {
+    Limb limb = limbs[i];
+    for (size_t k = kLimbDigits; k-- > 0;) {
+      buffer[k] = static_cast<char>('0' + limb % 10);
+      limb /= 10;
+    }
+    result.append(buffer, kLimbDigits);
+  }
+  return result;
+}
+
+DecimalSuperLong DecimalSuperLong::addSigned(const DecimalSuperLong& a, const DecimalSuperLong& b, bool negateB) {
+  bool bNegative = (b.sign == Sign::Negative) != negateB;
+  if ((a.sign == Sign::Negative) == bNegative) {
+    return DecimalSuperLong {a.sign, addMagnitudes(a.limbs.data(), a.limbs.size(), b.limbs.data(), b.limbs.size())};
+  }
+  if (compareMagnitudes(a.limbs, b.limbs) >= 0) {
+    Limbs result = a.limbs;
+    subtractInPlace(result.data(), result.size(), b.limbs.data(), b.limbs.size());
+    return DecimalSuperLong {a.sign, std::move(result)};
+  }
+  Limbs result = b.limbs;
+  subtractInPlace(result.data(), result.size(), a.limbs.data(), a.limbs.size());
+  return DecimalSuperLong {bNegative ? Sign::Negative : Sign::Positive, std::move(result)};
+}
+
+DecimalSuperLong DecimalSuperLong::operator+(const DecimalSuperLong& other) const {
+  return addSigned(*this, other, false);
+}
+
+DecimalSuperLong DecimalSuperLong::operator-(const DecimalSuperLong& other) const {
+  return addSigned(*this, other, true);
+}
+
+DecimalSuperLong DecimalSuperLong::operator*(const DecimalSuperLong& other) const {
+  return DecimalSuperLong {(sign == other.sign) ? Sign::Positive : Sign::Negative,
+                           multiplyMagnitudes(limbs, other.limbs)};
+}
+
+DecimalSuperLong DecimalSuperLong::operator-() const {
+  return DecimalSuperLong {(sign == Sign::Negative) ? Sign::Positive : Sign::Negative, limbs};
+}
+
+DecimalSuperLong& DecimalSuperLong::operator+=(const DecimalSuperLong& other) {
+  return *this = *this + other;
+}
+
+DecimalSuperLong& DecimalSuperLong::operator-=(const DecimalSuperLong& other) {
+  return *this = *this - other;
+}
+
+DecimalSuperLong& DecimalSuperLong::operator*=(const DecimalSuperLong& other) {
+  return *this = *this * other;
+}
+
+int DecimalSuperLong::compare(const DecimalSuperLong& a, const DecimalSuperLong& b) {
+  if (a.sign != b.sign) {
+    return (a.sign == Sign::Negative) ? -1 : 1;
+  }
+  int magnitude = compareMagnitudes(a.limbs, b.limbs);
+  return (a.sign == Sign::Negative) ? -magnitude : magnitude;
+}
+
+bool DecimalSuperLong::operator==(const DecimalSuperLong& other) const {
+  return sign == other.sign && limbs == other.limbs;
+}
+
+bool DecimalSuperLong::operator!=(const DecimalSuperLong& other) const {
+  return !(*this == other);
+}
+
+bool DecimalSuperLong::operator<(const DecimalSuperLong& other) const {
+  return compare(*this, other) < 0;
+}
+
+bool DecimalSuperLong::operator<=(const DecimalSuperLong& other) const {
+  return compare(*this, other) <= 0;
+}
+
+bool DecimalSuperLong::operator>(const DecimalSuperLong& other) const {
+  return compare(*this, other) > 0;
+}
+
+bool DecimalSuperLong::operator>=(const DecimalSuperLong& other) const {
+  return compare(*this, other) >= 0;
+}
+
+bool DecimalSuperLong::isZero() const {
+  return limbs.size() == 1 && limbs[0] == 0;
+}
+
+bool DecimalSuperLong::isNegative() const {
+  return sign == Sign::Negative;
+}
+
+size_t DecimalSuperLong::size() const {
+  return limbs.size();
+}
+
+void DecimalSuperLong::removeLeadingZeros() {
+  if (limbs.empty()) {
+    limbs.push_back(0);
+  }
+  trim(limbs);
+  if (isZero()) {
+    sign = Sign::Positive;
+  }
+}
+
+std::ostream& aoi::operator<<(std::ostream& os, const DecimalSuperLong& value) {
+  return os << value.toString();
+}
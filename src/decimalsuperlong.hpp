@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "superlong.hpp"
+
+namespace aoi {
+
+  // Integer with base-10^19 limbs for workloads that mostly parse, add and
+  // print decimal values: the string constructor and toString() are linear.
+  // Conversions to and from SuperLong are explicit and divide and conquer
+  // over squared powers of the other radix, so both cost O(M(n) log n)
+  class DecimalSuperLong {
+   public:
+    using Limb = uint64_t;
+    static constexpr Limb kBase = 10000000000000000000ULL;
+    static constexpr size_t kLimbDigits = 19;
+
+    DecimalSuperLong();
+    DecimalSuperLong(int64_t num);
+    explicit DecimalSuperLong(std::string_view str);
+    // Takes std::string ahead of its implicit conversion to SuperLong
+    template <typename Text,
+              std::enable_if_t<std::is_convertible_v<const Text&, std::string_view> &&
+                                   !std::is_convertible_v<const Text&, const char*>,
+                               int> = 0>
+    explicit DecimalSuperLong(const Text& str) : DecimalSuperLong(std::string_view {str}) {
+    }
+    explicit DecimalSuperLong(const SuperLong& value);
+
+    SuperLong toSuperLong() const;
+    std::string toString() const;
+
+    DecimalSuperLong operator+(const DecimalSuperLong& other) const;
+    DecimalSuperLong operator-(const DecimalSuperLong& other) const;
+    DecimalSuperLong operator*(const DecimalSuperLong& other) const;
+    DecimalSuperLong operator-() const;
+    DecimalSuperLong& operator+=(const DecimalSuperLong& other);
+    DecimalSuperLong& operator-=(const DecimalSuperLong& other);
+    DecimalSuperLong& operator*=(const DecimalSuperLong& other);
+
+    bool operator==(const DecimalSuperLong& other) const;
+    bool operator!=(const DecimalSuperLong& other) const;
+    bool operator<(const DecimalSuperLong& other) const;
+    bool operator<=(const DecimalSuperLong& other) const;
+    bool operator>(const DecimalSuperLong& other) const;
+    bool operator>=(const DecimalSuperLong& other) const;
+
+    bool isZero() const;
+    bool isNegative() const;
+    size_t size() const;
+
+   private:
+    Sign sign;
+    std::vector<Limb> limbs;
+
+    DecimalSuperLong(Sign sign, std::vector<Limb> limbs);
+
+    void removeLeadingZeros();
+    static DecimalSuperLong addSigned(const DecimalSuperLong& a, const DecimalSuperLong& b, bool negateB);
+    static int compare(const DecimalSuperLong& a, const DecimalSuperLong& b);
+
+    static SuperLong binaryLeaf(const Limb* in, size_t count);
+    static SuperLong toBinary(const Limb* in, size_t count, const std::vector<SuperLong>& powers, size_t level);
+  };
+
+  std::ostream& operator<<(std::ostream& os, const DecimalSuperLong& value);
+
+}
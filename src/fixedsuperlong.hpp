@@ -0,0 +1,309 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "superlong.hpp"
+#include "superlong-trace.hpp"
+
+namespace aoi {
+
+  // Fixed-width two's complement integer in [-2^(Bits-1), 2^(Bits-1)) stored
+  // in a std::array, so it never allocates. Arithmetic wraps modulo 2^Bits;
+  // division, remainder and shifts follow SuperLong (truncation toward zero,
+  // remainder takes the dividend's sign, shifts act on the magnitude)
+  template <size_t Bits>
+  class FixedSuperLong {
+    static_assert(Bits > 0 && Bits % 32 == 0, "FixedSuperLong width must be a positive multiple of 32 bits");
+
+   public:
+    using Limb = uint32_t;
+    static constexpr size_t kLimbBits = 32;
+    static constexpr size_t kLimbs = Bits / kLimbBits;
+
+    constexpr FixedSuperLong() : limbs {} {
+    }
+
+    constexpr FixedSuperLong(int64_t num) : limbs {} {
+      uint64_t bits = static_cast<uint64_t>(num);
+      Limb fill = (num < 0) ? ~Limb {0} : Limb {0};
+      for (size_t i = 0; i < kLimbs; i++) {
+        limbs[i] = (i < 2) ? static_cast<Limb>(bits >> (kLimbBits * i)) : fill;
+      }
+    }
+
+    explicit FixedSuperLong(const SuperLong& value) : limbs {} {
+      const LimbBuffer& digits = value.digits;
+      if (digits.size() > Bits / 8) {
+        throw std::out_of_range("Value does not fit in FixedSuperLong");
+      }
+      for (size_t i = 0; i < digits.size(); i++) {
+        limbs[i / 4] |= static_cast<Limb>(digits[i]) << (8 * (i % 4));
+      }
+      bool topBit = (limbs[kLimbs - 1] >> (kLimbBits - 1)) != 0;
+      if (value.isNegative()) {
+        negate();
+        if (topBit && !isNegative()) {
+          throw std::out_of_range("Value does not fit in FixedSuperLong");
+        }
+      } else if (topBit) {
+        throw std::out_of_range("Value does not fit in FixedSuperLong");
+      }
+    }
+
+    SuperLong toSuperLong() const {
+      FixedSuperLong magnitude = isNegative() ? -*this : *this;
+      SuperLong result;
+      result.digits.assign(Bits / 8, 0);
+      for (size_t i = 0; i < Bits / 8; i++) {
+        result.digits[i] = static_cast<n256>(magnitude.limbs[i / 4] >> (8 * (i % 4)));
+      }
+      result.sign = isNegative() ? Sign::Negative : Sign::Positive;
+      result.removeLeadingZeros();
+      return result;
+    }
+
+    std::string toString() const {
+      detail::UntracedScope untraced;
+      return toSuperLong().toString();
+    }
+
+    constexpr FixedSuperLong operator+(const FixedSuperLong& other) const {
+      FixedSuperLong result;
+      uint64_t carry = 0;
+      for (size_t i = 0; i < kLimbs; i++) {
+        uint64_t sum = static_cast<uint64_t>(limbs[i]) + other.limbs[i] + carry;
+        result.limbs[i] = static_cast<Limb>(sum);
+        carry = sum >> kLimbBits;
+      }
+      return result;
+    }
+
+    constexpr FixedSuperLong operator-(const FixedSuperLong& other) const {
+      FixedSuperLong result;
+      uint64_t borrow = 0;
+      for (size_t i = 0; i < kLimbs; i++) {
+        uint64_t diff = static_cast<uint64_t>(limbs[i]) - other.limbs[i] - borrow;
+        result.limbs[i] = static_cast<Limb>(diff);
+        borrow = (diff >> kLimbBits) & 1;
+      }
+      return result;
+    }
+
+    constexpr FixedSuperLong operator-() const {
+      FixedSuperLong result {*this};
+      result.negate();
+      return result;
+    }
+
+    constexpr FixedSuperLong operator*(const FixedSuperLong& other) const {
+      FixedSuperLong result;
+      for (size_t i = 0; i < kLimbs; i++) {
+        uint64_t carry = 0;
+        for (size_t j = 0; i + j < kLimbs; j++) {
+          uint64_t product = static_cast<uint64_t>(limbs[i]) * other.limbs[j] + result.limbs[i + j] + carry;
+          result.limbs[i + j] = static_cast<Limb>(product);
+          carry = product >> kLimbBits;
+        }
+      }
+      return result;
+    }
+
+    constexpr FixedSuperLong operator/(const FixedSuperLong& other) const {
+      return divide(*this, other).quotient;
+    }
+
+    constexpr FixedSuperLong operator%(const FixedSuperLong& other) const {
+      return divide(*this, other).remainder;
+    }
+
+    constexpr FixedSuperLong operator<<(size_t shift) const {
+      return shiftMagnitude(shift, true);
+    }
+
+    constexpr FixedSuperLong operator>>(size_t shift) const {
+      return shiftMagnitude(shift, false);
+    }
+
+    constexpr FixedSuperLong& operator+=(const FixedSuperLong& other) {
+      return *this = *this + other;
+    }
+
+    constexpr FixedSuperLong& operator-=(const FixedSuperLong& other) {
+      return *this = *this - other;
+    }
+
+    constexpr FixedSuperLong& operator*=(const FixedSuperLong& other) {
+      return *this = *this * other;
+    }
+
+    constexpr FixedSuperLong& operator/=(const FixedSuperLong& other) {
+      return *this = *this / other;
+    }
+
+    constexpr FixedSuperLong& operator%=(const FixedSuperLong& other) {
+      return *this = *this % other;
+    }
+
+    constexpr FixedSuperLong& operator<<=(size_t shift) {
+      return *this = *this << shift;
+    }
+
+    constexpr FixedSuperLong& operator>>=(size_t shift) {
+      return *this = *this >> shift;
+    }
+
+    constexpr FixedSuperLong& operator++() {
+      return *this += FixedSuperLong {1};
+    }
+
+    constexpr FixedSuperLong operator++(int) {
+      FixedSuperLong temp {*this};
+      ++*this;
+      return temp;
+    }
+
+    constexpr FixedSuperLong& operator--() {
+      return *this -= FixedSuperLong {1};
+    }
+
+    constexpr FixedSuperLong operator--(int) {
+      FixedSuperLong temp {*this};
+      --*this;
+      return temp;
+    }
+
+    constexpr bool operator==(const FixedSuperLong& other) const {
+      for (size_t i = 0; i < kLimbs; i++) {
+        if (limbs[i] != other.limbs[i]) {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    constexpr bool operator!=(const FixedSuperLong& other) const {
+      return !(*this == other);
+    }
+
+    constexpr bool operator<(const FixedSuperLong& other) const {
+      if (isNegative() != other.isNegative()) {
+        return isNegative();
+      }
+      return compareUnsigned(*this, other) < 0;
+    }
+
+    constexpr bool operator<=(const FixedSuperLong& other) const {
+      return !(other < *this);
+    }
+
+    constexpr bool operator>(const FixedSuperLong& other) const {
+      return other < *this;
+    }
+
+    constexpr bool operator>=(const FixedSuperLong& other) const {
+      return !(*this < other);
+    }
+
+    constexpr void negate() {
+      uint64_t carry = 1;
+      for (size_t i = 0; i < kLimbs; i++) {
+        uint64_t sum = static_cast<uint64_t>(static_cast<Limb>(~limbs[i])) + carry;
+        limbs[i] = static_cast<Limb>(sum);
+        carry = sum >> kLimbBits;
+      }
+    }
+
+    constexpr bool isZero() const {
+      return *this == FixedSuperLong {};
+    }
+
+    constexpr bool isNegative() const {
+      return (limbs[kLimbs - 1] >> (kLimbBits - 1)) != 0;
+    }
+
+    constexpr bool isPositive() const {
+      return !isNegative();
+    }
+
+   private:
+    std::array<Limb, kLimbs> limbs;
+
+    struct DivisionResult {
+      FixedSuperLong quotient;
+      FixedSuperLong remainder;
+    };
+
+    static constexpr int compareUnsigned(const FixedSuperLong& a, const FixedSuperLong& b) {
+      for (size_t i = kLimbs; i-- > 0;) {
+        if (a.limbs[i] != b.limbs[i]) {
+          return (a.limbs[i] < b.limbs[i]) ? -1 : 1;
+        }
+      }
+      return 0;
+    }
+
+    // Shift-subtract long division on the magnitudes; the magnitude of
+    // -2^(Bits-1) is read back as the unsigned value 2^(Bits-1)
+    static constexpr DivisionResult divide(const FixedSuperLong& a, const FixedSuperLong& b) {
+      if (b.isZero()) {
+        throw std::invalid_argument("Division by zero");
+      }
+      FixedSuperLong dividend = a.isNegative() ? -a : a;
+      FixedSuperLong divisor = b.isNegative() ? -b : b;
+      FixedSuperLong quotient;
+      FixedSuperLong remainder;
+
+      for (size_t bit = Bits; bit-- > 0;) {
+        for (size_t i = kLimbs; i-- > 1;) {
+          remainder.limbs[i] = (remainder.limbs[i] << 1) | (remainder.limbs[i - 1] >> (kLimbBits - 1));
+        }
+        remainder.limbs[0] = (remainder.limbs[0] << 1) | ((dividend.limbs[bit / kLimbBits] >> (bit % kLimbBits)) & 1);
+        if (compareUnsigned(remainder, divisor) >= 0) {
+          remainder -= divisor;
+          quotient.limbs[bit / kLimbBits] |= Limb {1} << (bit % kLimbBits);
+        }
+      }
+
+      if (a.isNegative() != b.isNegative()) {
+        quotient.negate();
+      }
+      if (a.isNegative()) {
+        remainder.negate();
+      }
+      return {quotient, remainder};
+    }
+
+    constexpr FixedSuperLong shiftMagnitude(size_t shift, bool left) const {
+      bool negative = isNegative();
+      FixedSuperLong magnitude = negative ? -*this : *this;
+      FixedSuperLong result;
+      if (shift < Bits) {
+        size_t limbShift = shift / kLimbBits;
+        size_t bitShift = shift % kLimbBits;
+        for (size_t i = 0; i < kLimbs; i++) {
+          uint64_t word = 0;
+          if (left && i >= limbShift) {
+            word = static_cast<uint64_t>(magnitude.limbs[i - limbShift]) << bitShift;
+            if (bitShift > 0 && i > limbShift) {
+              word |= magnitude.limbs[i - limbShift - 1] >> (kLimbBits - bitShift);
+            }
+          } else if (!left && i + limbShift < kLimbs) {
+            word = magnitude.limbs[i + limbShift] >> bitShift;
+            if (bitShift > 0 && i + limbShift + 1 < kLimbs) {
+              word |= static_cast<uint64_t>(magnitude.limbs[i + limbShift + 1]) << (kLimbBits - bitShift);
+            }
+          }
+          result.limbs[i] = static_cast<Limb>(word);
+        }
+      }
+      if (negative) {
+        result.negate();
+      }
+      return result;
+    }
+  };
+
+}
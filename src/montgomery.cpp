@@ -0,0 +1,233 @@
+#include "montgomery.hpp"
+#include "superlong-trace.hpp"
+
+#include <stdexcept>
+
+using namespace aoi;
+
+static constexpr size_t kWordBits = 32;
+static constexpr size_t kLimbsPerWord = sizeof(Montgomery::Word);
+
+// Newton iteration for m^-1 mod 2^32; each step doubles the correct low bits
+static Montgomery::Word negatedInverse(Montgomery::Word m) {
+  Montgomery::Word x = m;
+  for (int i = 0; i < 5; i++) {
+    x *= 2 - m * x;
+  }
+  return ~x + 1;
+}
+
+Montgomery::Montgomery(const SuperLong& modulus) : mod(modulus) {
+  detail::UntracedScope untraced;
+  if (modulus <= SuperLong {1} || (modulus.digits[0] & 1) == 0) {
+    throw std::invalid_argument("Montgomery modulus must be odd and greater than one");
+  }
+  size_t count = (modulus.digits.size() + kLimbsPerWord - 1) / kLimbsPerWord;
+  words = toWords(modulus, count);
+  inverse = negatedInverse(words[0]);
+  rOne = toWords((SuperLong {1} << (kWordBits * count)) % modulus, count);
+  rSquared = toWords((SuperLong {1} << (2 * kWordBits * count)) % modulus, count);
+}
+
+size_t Montgomery::size() const {
+  return words.size();
+}
+
+const SuperLong& Montgomery::modulus() const {
+  return mod;
+}
+
+const std::vector<Montgomery::Word>& Montgomery::modulusWords() const {
+  return words;
+}
+
+Montgomery::Word Montgomery::wordInverse() const {
+  return inverse;
+}
+
+Montgomery::Residue Montgomery::toMontgomery(const SuperLong& value) const {
+  detail::UntracedScope untraced;
+  SuperLong reduced = value;
+  if (reduced.isNegative() || reduced >= mod) {
+    reduced %= mod;
+    if (reduced.isNegative()) {
+      reduced += mod;
+    }
+  }
+  Residue result = toWords(reduced, words.size());
+  multiply(result, rSquared, result);
+  return result;
+}
+
+SuperLong Montgomery::fromMontgomery(const Residue& value) const {
+  detail::UntracedScope untraced;
+  Residue unit = zero();
+  unit[0] = 1;
+  multiply(value, unit, unit);
+  return fromWords(unit);
+}
+
+Montgomery::Residue Montgomery::zero() const {
+  return Residue(words.size(), 0);
+}
+
+Montgomery::Residue Montgomery::one() const {
+  return rOne;
+}
+
+bool Montgomery::isZero(const Residue& value) {
+  for (Word w : value) {
+    if (w != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Coarsely integrated operand scanning: one row of a * b[i] is added and
+// one multiple of m cancels the lowest word, so t stays n + 2 words wide
+void Montgomery::multiply(const Residue& a, const Residue& b, Residue& out) const {
+  size_t n = words.size();
+  static thread_local std::vector<Word> scratch;
+  scratch.assign(n + 2, 0);
+  Word* t = scratch.data();
+  const Word* m = words.data();
+
+  for (size_t i = 0; i < n; i++) {
+    uint64_t carry = 0;
+    uint64_t bi = b[i];
+    for (size_t j = 0; j < n; j++) {
+      uint64_t cur = t[j] + a[j] * bi + carry;
+      t[j] = static_cast<Word>(cur);
+      carry = cur >> kWordBits;
+    }
+    uint64_t top = t[n] + carry;
+    t[n] = static_cast<Word>(top);
+    t[n + 1] = static_cast<Word>(top >> kWordBits);
+
+    uint64_t q = static_cast<Word>(t[0] * inverse);
+    carry = (t[0] + q * m[0]) >> kWordBits;
+    for (size_t j = 1; j < n; j++) {
+      uint64_t cur = t[j] + q * m[j] + carry;
+      t[j - 1] = static_cast<Word>(cur);
+      carry = cur >> kWordBits;
+    }
+    top = t[n] + carry;
+    t[n - 1] = static_cast<Word>(top);
+    t[n] = t[n + 1] + static_cast<Word>(top >> kWordBits);
+  }
+
+  if (t[n] != 0 || !belowModulus(t)) {
+    subtractModulus(t);
+  }
+  out.assign(t, t + n);
+}
+
+void Montgomery::add(const Residue& a, const Residue& b, Residue& out) const {
+  size_t n = words.size();
+  out.resize(n);
+  uint64_t carry = 0;
+  for (size_t i = 0; i < n; i++) {
+    uint64_t cur = uint64_t {a[i]} + b[i] + carry;
+    out[i] = static_cast<Word>(cur);
+    carry = cur >> kWordBits;
+  }
+  if (carry != 0 || !belowModulus(out.data())) {
+    subtractModulus(out.data());
+  }
+}
+
+void Montgomery::subtract(const Residue& a, const Residue& b, Residue& out) const {
+  size_t n = words.size();
+  out.resize(n);
+  uint64_t borrow = 0;
+  for (size_t i = 0; i < n; i++) {
+    uint64_t cur = uint64_t {a[i]} - b[i] - borrow;
+    out[i] = static_cast<Word>(cur);
+    borrow = (cur >> kWordBits) & 1;
+  }
+  if (borrow != 0) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; i++) {
+      uint64_t cur = uint64_t {out[i]} + words[i] + carry;
+      out[i] = static_cast<Word>(cur);
+      carry = cur >> kWordBits;
+    }
+  }
+}
+
+void Montgomery::half(const Residue& value, Residue& out) const {
+  size_t n = words.size();
+  out.resize(n);
+  // An odd value becomes even by adding the odd modulus; the carry out of
+  // that sum is the top bit after the shift
+  uint64_t carry = 0;
+  if (value[0] & 1) {
+    for (size_t i = 0; i < n; i++) {
+      uint64_t cur = uint64_t {value[i]} + words[i] + carry;
+      out[i] = static_cast<Word>(cur);
+      carry = cur >> kWordBits;
+    }
+  } else {
+    out.assign(value.begin(), value.end());
+  }
+  for (size_t i = 0; i + 1 < n; i++) {
+    out[i] = (out[i] >> 1) | (out[i + 1] << (kWordBits - 1));
+  }
+  out[n - 1] = (out[n - 1] >> 1) | static_cast<Word>(carry << (kWordBits - 1));
+}
+
+Montgomery::Residue Montgomery::pow(const Residue& base, const SuperLong& exponent) const {
+  detail::UntracedScope untraced;
+  if (exponent.isNegative()) {
+    throw std::invalid_argument("Montgomery exponent must be non-negative");
+  }
+  Residue result = rOne;
+  for (size_t bit = exponent.bitLength(); bit-- > 0;) {
+    multiply(result, result, result);
+    if ((exponent.digits[bit / 8] >> (bit % 8)) & 1) {
+      multiply(result, base, result);
+    }
+  }
+  return result;
+}
+
+SuperLong Montgomery::powMod(const SuperLong& base, const SuperLong& exponent) const {
+  detail::UntracedScope untraced;
+  return fromMontgomery(pow(toMontgomery(base), exponent));
+}
+
+std::vector<Montgomery::Word> Montgomery::toWords(const SuperLong& value, size_t count) {
+  std::vector<Word> result(count, 0);
+  const n256* limbs = value.digits.data();
+  for (size_t i = 0; i < value.digits.size(); i++) {
+    result[i / kLimbsPerWord] |= Word {limbs[i]} << (8 * (i % kLimbsPerWord));
+  }
+  return result;
+}
+
+SuperLong Montgomery::fromWords(const std::vector<Word>& value) {
+  std::vector<n256> limbs(value.size() * kLimbsPerWord);
+  for (size_t i = 0; i < limbs.size(); i++) {
+    limbs[i] = static_cast<n256>(value[i / kLimbsPerWord] >> (8 * (i % kLimbsPerWord)));
+  }
+  return SuperLong {Sign::Positive, limbs.data(), limbs.size()};
+}
+
+bool Montgomery::belowModulus(const Word* value) const {
+  for (size_t i = words.size(); i-- > 0;) {
+    if (value[i] != words[i]) {
+      return value[i] < words[i];
+    }
+  }
+  return false;
+}
+
+void Montgomery::subtractModulus(Word* value) const {
+  uint64_t borrow = 0;
+  for (size_t i = 0; i < words.size(); i++) {
+    uint64_t cur = uint64_t {value[i]} - words[i] - borrow;
+    value[i] = static_cast<Word>(cur);
+    borrow = (cur >> kWordBits) & 1;
+  }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "superlong.hpp"
+
+namespace aoi {
+
+  // Montgomery arithmetic modulo a fixed odd modulus m > 1 on 32-bit words.
+  // A Residue holds x * R mod m as size() little-endian words, R = 2^(32 *
+  // size()). Build the context once per modulus and reuse it: the setup
+  // costs one long division, while each multiplication is a single CIOS pass
+  class Montgomery {
+   public:
+    using Word = uint32_t;
+    using Residue = std::vector<Word>;
+
+    explicit Montgomery(const SuperLong& modulus);
+
+    size_t size() const;
+    const SuperLong& modulus() const;
+    const std::vector<Word>& modulusWords() const;
+    // -m^-1 mod 2^32, the per-word reduction factor
+    Word wordInverse() const;
+
+    // Accepts any value, including negative ones, and reduces it first
+    Residue toMontgomery(const SuperLong& value) const;
+    SuperLong fromMontgomery(const Residue& value) const;
+
+    Residue zero() const;
+    Residue one() const;
+    static bool isZero(const Residue& value);
+
+    // `out` may alias either operand
+    void multiply(const Residue& a, const Residue& b, Residue& out) const;
+    void add(const Residue& a, const Residue& b, Residue& out) const;
+    void subtract(const Residue& a, const Residue& b, Residue& out) const;
+    // value / 2 mod m
+    void half(const Residue& value, Residue& out) const;
+
+    Residue pow(const Residue& base, const SuperLong& exponent) const;
+    SuperLong powMod(const SuperLong& base, const SuperLong& exponent) const;
+
+   private:
+    SuperLong mod;
+    std::vector<Word> words;
+    // -m^-1 mod 2^32
+    Word inverse;
+    Residue rSquared;
+    Residue rOne;
+
+    static std::vector<Word> toWords(const SuperLong& value, size_t count);
+    static SuperLong fromWords(const std::vector<Word>& value);
+    bool belowModulus(const Word* value) const;
+    void subtractModulus(Word* value) const;
+  };
+
+}
@@ -0,0 +1,364 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#endif
+
+#include "montgomery.hpp"
+#include "superlong.hpp"
+
+namespace aoi {
+
+  enum class BatchKernel { Scalar, Avx2, Avx512 };
+
+  // Montgomery arithmetic on Lanes independent moduli of equal word count.
+  // Residues are interleaved word-major, lane-minor: word j of lane l sits
+  // at index j * Lanes + l, so every CIOS row is one multiply-add pass over
+  // all lanes. On x86 the AVX2 and AVX-512 row kernels are compiled with a
+  // target attribute into every build and picked at run time from the CPU,
+  // handling 4 or 8 lanes per instruction. The scalar kernel hands each
+  // lane to its own Montgomery context
+  template <size_t Lanes>
+  class MontgomeryBatch {
+    static_assert(Lanes == 4 || Lanes == 8 || Lanes == 16, "MontgomeryBatch supports 4, 8 or 16 lanes");
+
+   public:
+    using Word = Montgomery::Word;
+    using Residues = std::vector<Word>;
+    using Kernel = BatchKernel;
+
+    explicit MontgomeryBatch(const std::vector<SuperLong>& moduli) {
+      checkCount(moduli.size());
+      contexts.reserve(Lanes);
+      for (const SuperLong& modulus : moduli) {
+        contexts.emplace_back(modulus);
+        if (contexts.back().size() != contexts.front().size()) {
+          throw std::invalid_argument("Batch moduli must have the same word count");
+        }
+      }
+      words = contexts.front().size();
+      mods.resize(words * Lanes);
+      for (size_t l = 0; l < Lanes; l++) {
+        inverses[l] = contexts[l].wordInverse();
+      }
+      interleave(mods, splitModuli());
+      std::vector<Montgomery::Residue> ones;
+      for (const Montgomery& context : contexts) {
+        ones.push_back(context.one());
+      }
+      rOne.resize(words * Lanes);
+      interleave(rOne, ones);
+      useKernel(supports(Kernel::Avx512) ? Kernel::Avx512
+                : supports(Kernel::Avx2) ? Kernel::Avx2
+                                         : Kernel::Scalar);
+    }
+
+    // Whether this CPU and lane count can run the kernel; AVX-512 needs a
+    // multiple of 8 lanes
+    static bool supports(Kernel kernel) {
+      switch (kernel) {
+        case Kernel::Scalar:
+          return true;
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+        case Kernel::Avx2:
+          return __builtin_cpu_supports("avx2");
+        case Kernel::Avx512:
+          return Lanes % 8 == 0 && __builtin_cpu_supports("avx512f");
+#endif
+        default:
+          return false;
+      }
+    }
+
+    Kernel kernel() const {
+      return active;
+    }
+
+    // Overrides the kernel picked at construction, e.g. to compare them
+    void useKernel(Kernel kernel) {
+      if (!supports(kernel)) {
+        throw std::invalid_argument("Batch kernel is not supported on this CPU");
+      }
+      active = kernel;
+      switch (kernel) {
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+        case Kernel::Avx2:
+          row = &multiplyAddRowAvx2;
+          break;
+        case Kernel::Avx512:
+          row = &multiplyAddRowAvx512;
+          break;
+#endif
+        default:
+          row = nullptr;
+          break;
+      }
+    }
+
+    static constexpr size_t lanes() {
+      return Lanes;
+    }
+
+    size_t size() const {
+      return words;
+    }
+
+    const Montgomery& context(size_t lane) const {
+      return contexts.at(lane);
+    }
+
+    Residues toMontgomery(const std::vector<SuperLong>& values) const {
+      checkCount(values.size());
+      std::vector<Montgomery::Residue> split;
+      for (size_t l = 0; l < Lanes; l++) {
+        split.push_back(contexts[l].toMontgomery(values[l]));
+      }
+      Residues result(words * Lanes);
+      interleave(result, split);
+      return result;
+    }
+
+    std::vector<SuperLong> fromMontgomery(const Residues& values) const {
+      std::vector<SuperLong> result;
+      result.reserve(Lanes);
+      Montgomery::Residue lane(words);
+      for (size_t l = 0; l < Lanes; l++) {
+        for (size_t j = 0; j < words; j++) {
+          lane[j] = values[j * Lanes + l];
+        }
+        result.push_back(contexts[l].fromMontgomery(lane));
+      }
+      return result;
+    }
+
+    Residues one() const {
+      return rOne;
+    }
+
+    // Lane-wise CIOS; `out` may alias either operand
+    void multiply(const Residues& a, const Residues& b, Residues& out) const {
+      size_t n = words;
+      if (row == nullptr) {
+        multiplyPerLane(a, b, out);
+        return;
+      }
+      static thread_local std::vector<Word> scratch;
+      // The row below t takes the word each reduction pass shifts out
+      scratch.assign((n + 3) * Lanes, 0);
+      Word* t = scratch.data() + Lanes;
+      Word* tn = t + n * Lanes;
+      uint64_t carry[Lanes];
+      Word q[Lanes];
+
+      for (size_t i = 0; i < n; i++) {
+        std::fill(carry, carry + Lanes, 0);
+        row(t, a.data(), b.data() + i * Lanes, carry, n, t);
+        for (size_t l = 0; l < Lanes; l++) {
+          uint64_t top = tn[l] + carry[l];
+          tn[l] = static_cast<Word>(top);
+          tn[Lanes + l] = static_cast<Word>(top >> kWordBits);
+          q[l] = t[l] * inverses[l];
+        }
+
+        std::fill(carry, carry + Lanes, 0);
+        row(t, mods.data(), q, carry, n, t - Lanes);
+        for (size_t l = 0; l < Lanes; l++) {
+          uint64_t top = tn[l] + carry[l];
+          t[(n - 1) * Lanes + l] = static_cast<Word>(top);
+          tn[l] = tn[Lanes + l] + static_cast<Word>(top >> kWordBits);
+        }
+      }
+
+      reduceOnce(t);
+      out.assign(t, t + n * Lanes);
+    }
+
+    // Left-to-right square and multiply with a separate exponent per lane;
+    // every step multiplies all lanes and keeps the product only in lanes
+    // whose exponent bit is set
+    Residues pow(const Residues& base, const std::vector<SuperLong>& exponents) const {
+      checkCount(exponents.size());
+      std::string bits[Lanes];
+      size_t length = 0;
+      for (size_t l = 0; l < Lanes; l++) {
+        if (exponents[l].isNegative()) {
+          throw std::invalid_argument("Montgomery exponent must be non-negative");
+        }
+        bits[l] = exponents[l].isZero() ? std::string() : exponents[l].toString(2);
+        length = std::max(length, bits[l].size());
+      }
+      Residues result = rOne;
+      Residues product;
+      for (size_t k = length; k-- > 0;) {
+        multiply(result, result, result);
+        multiply(result, base, product);
+        for (size_t l = 0; l < Lanes; l++) {
+          size_t width = bits[l].size();
+          if (k < width && bits[l][width - 1 - k] == '1') {
+            for (size_t j = 0; j < words; j++) {
+              result[j * Lanes + l] = product[j * Lanes + l];
+            }
+          }
+        }
+      }
+      return result;
+    }
+
+    std::vector<SuperLong> mulMod(const std::vector<SuperLong>& a, const std::vector<SuperLong>& b) const {
+      Residues product;
+      multiply(toMontgomery(a), toMontgomery(b), product);
+      return fromMontgomery(product);
+    }
+
+    std::vector<SuperLong> powMod(const std::vector<SuperLong>& bases, const std::vector<SuperLong>& exponents) const {
+      return fromMontgomery(pow(toMontgomery(bases), exponents));
+    }
+
+   private:
+    static constexpr size_t kWordBits = 32;
+
+    // Without vector rows, a strided walk over interleaved lanes only loses
+    // to Montgomery::multiply on contiguous words, so each lane is gathered
+    // and multiplied on its own
+    void multiplyPerLane(const Residues& a, const Residues& b, Residues& out) const {
+      size_t n = words;
+      static thread_local Montgomery::Residue x, y;
+      x.resize(n);
+      y.resize(n);
+      out.resize(n * Lanes);
+      for (size_t l = 0; l < Lanes; l++) {
+        for (size_t j = 0; j < n; j++) {
+          x[j] = a[j * Lanes + l];
+          y[j] = b[j * Lanes + l];
+        }
+        contexts[l].multiply(x, y, x);
+        for (size_t j = 0; j < n; j++) {
+          out[j * Lanes + l] = x[j];
+        }
+      }
+    }
+
+    // For j < count and every lane l: out[j * Lanes + l] = low word of
+    // t[j * Lanes + l] + x[j * Lanes + l] * y[l] + carry[l], and carry[l]
+    // takes the high word. Row j is read before row j - 1 is written, so
+    // `out` may be t or t shifted down one row
+    using RowKernel = void (*)(const Word* t, const Word* x, const Word* y, uint64_t* carry, size_t count,
+                               Word* out);
+
+    std::vector<Montgomery> contexts;
+    size_t words = 0;
+    Residues mods;
+    Word inverses[Lanes];
+    Residues rOne;
+    Kernel active = Kernel::Scalar;
+    // Null for the scalar kernel
+    RowKernel row = nullptr;
+
+    static void checkCount(size_t count) {
+      if (count != Lanes) {
+        throw std::invalid_argument("MontgomeryBatch needs exactly one value per lane");
+      }
+    }
+
+    std::vector<Montgomery::Residue> splitModuli() const {
+      std::vector<Montgomery::Residue> result;
+      for (const Montgomery& context : contexts) {
+        result.push_back(context.modulusWords());
+      }
+      return result;
+    }
+
+    void interleave(Residues& out, const std::vector<Montgomery::Residue>& split) const {
+      for (size_t l = 0; l < Lanes; l++) {
+        for (size_t j = 0; j < words; j++) {
+          out[j * Lanes + l] = split[l][j];
+        }
+      }
+    }
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    __attribute__((target("avx2"))) static void multiplyAddRowAvx2(const Word* t, const Word* x, const Word* y,
+                                                                   uint64_t* carry, size_t count, Word* out) {
+      // Gathers the low halves of the four 64-bit sums into the bottom 128 bits
+      const __m256i pack = _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7);
+      for (size_t l = 0; l < Lanes; l += 4) {
+        __m256i yv = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y + l)));
+        __m256i cv = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(carry + l));
+        for (size_t j = 0; j < count; j++) {
+          size_t at = j * Lanes + l;
+          __m256i tv = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(t + at)));
+          __m256i xv = _mm256_cvtepu32_epi64(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + at)));
+          __m256i cur = _mm256_add_epi64(_mm256_mul_epu32(xv, yv), _mm256_add_epi64(tv, cv));
+          __m256i low = _mm256_permutevar8x32_epi32(cur, pack);
+          _mm_storeu_si128(reinterpret_cast<__m128i*>(out + at), _mm256_castsi256_si128(low));
+          cv = _mm256_srli_epi64(cur, kWordBits);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(carry + l), cv);
+      }
+    }
+
+// GCC 12 flags the undefined pass-through operand inside every unmasked
+// AVX-512 intrinsic as uninitialized
+#if !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+    __attribute__((target("avx512f"))) static void multiplyAddRowAvx512(const Word* t, const Word* x,
+                                                                        const Word* y, uint64_t* carry,
+                                                                        size_t count, Word* out) {
+      for (size_t l = 0; l + 8 <= Lanes; l += 8) {
+        __m512i yv = _mm512_cvtepu32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + l)));
+        __m512i cv = _mm512_loadu_si512(carry + l);
+        for (size_t j = 0; j < count; j++) {
+          size_t at = j * Lanes + l;
+          __m512i tv = _mm512_cvtepu32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(t + at)));
+          __m512i xv = _mm512_cvtepu32_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + at)));
+          __m512i cur = _mm512_add_epi64(_mm512_mul_epu32(xv, yv), _mm512_add_epi64(tv, cv));
+          _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + at), _mm512_cvtepi64_epi32(cur));
+          cv = _mm512_srli_epi64(cur, kWordBits);
+        }
+        _mm512_storeu_si512(carry + l, cv);
+      }
+    }
+#if !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#endif
+
+    // Subtracts m from every lane whose value, with top word t[n], is at
+    // least m; the selection is branch-free so the lanes stay in step
+    void reduceOnce(Word* t) const {
+      size_t n = words;
+      static thread_local std::vector<Word> difference;
+      difference.resize(n * Lanes);
+      uint64_t borrow[Lanes] = {};
+      for (size_t j = 0; j < n; j++) {
+        for (size_t l = 0; l < Lanes; l++) {
+          uint64_t cur = uint64_t {t[j * Lanes + l]} - mods[j * Lanes + l] - borrow[l];
+          difference[j * Lanes + l] = static_cast<Word>(cur);
+          borrow[l] = (cur >> kWordBits) & 1;
+        }
+      }
+      Word keep[Lanes];
+      for (size_t l = 0; l < Lanes; l++) {
+        // All ones when the subtraction stands: a carry word or no borrow
+        keep[l] = Word {0} - static_cast<Word>((t[n * Lanes + l] != 0) | (borrow[l] == 0));
+      }
+      for (size_t j = 0; j < n; j++) {
+        for (size_t l = 0; l < Lanes; l++) {
+          Word& w = t[j * Lanes + l];
+          w = (difference[j * Lanes + l] & keep[l]) | (w & ~keep[l]);
+        }
+      }
+    }
+  };
+
+}
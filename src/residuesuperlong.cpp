@@ -0,0 +1,276 @@
+#include "residuesuperlong.hpp"
+#include "superlong-trace.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+using namespace aoi;
+
+// Primes are taken downward from here, so each carries almost 31 bits
+static constexpr uint32_t kLargestPrimeCandidate = (uint32_t {1} << 31) - 1;
+
+// Miller-Rabin with these bases is exact for every n < 4,759,123,141
+static constexpr uint32_t kWitnesses[] = {2, 7, 61};
+
+static uint32_t powMod(uint64_t base, uint64_t exponent, uint64_t modulus) {
+  uint64_t result = 1;
+  base %= modulus;
+  while (exponent > 0) {
+    if (exponent & 1) {
+      result = result * base % modulus;
+    }
+    base = base * base % modulus;
+    exponent >>= 1;
+  }
+  return static_cast<uint32_t>(result);
+}
+
+static bool isPrime32(uint32_t n) {
+  if (n < 2 || n % 2 == 0) {
+    return n == 2;
+  }
+  uint32_t d = n - 1;
+  int s = 0;
+  while (d % 2 == 0) {
+    d /= 2;
+    s++;
+  }
+  for (uint32_t a : kWitnesses) {
+    if (a % n == 0) {
+      continue;
+    }
+    uint64_t x = powMod(a, d, n);
+    if (x == 1 || x == n - 1) {
+      continue;
+    }
+    bool composite = true;
+    for (int r = 1; r < s && composite; r++) {
+      x = x * x % n;
+      composite = (x != n - 1);
+    }
+    if (composite) {
+      return false;
+    }
+  }
+  return true;
+}
+
+ResidueBasis::ResidueBasis(size_t bits) : bits(bits) {
+  detail::UntracedScope untraced;
+  double collected = 0;
+  for (uint32_t candidate = kLargestPrimeCandidate; collected <= static_cast<double>(bits) + 2; candidate -= 2) {
+    if (isPrime32(candidate)) {
+      moduli.push_back(candidate);
+      collected += std::log2(static_cast<double>(candidate));
+    }
+  }
+
+  inverses.resize(moduli.size());
+  for (size_t i = 0; i < moduli.size(); i++) {
+    uint64_t cofactor = 1;
+    for (size_t j = 0; j < moduli.size(); j++) {
+      if (j != i) {
+        cofactor = cofactor * (moduli[j] % moduli[i]) % moduli[i];
+      }
+    }
+    inverses[i] = powMod(cofactor, moduli[i] - 2, moduli[i]);
+  }
+
+  tree.emplace_back();
+  for (uint32_t p : moduli) {
+    tree.back().push_back(SuperLong {static_cast<int64_t>(p)});
+  }
+  while (tree.back().size() > 1) {
+    const std::vector<SuperLong>& below = tree.back();
+    std::vector<SuperLong> level;
+    for (size_t i = 0; i < below.size(); i += 2) {
+      level.push_back((i + 1 < below.size()) ? below[i] * below[i + 1] : below[i]);
+    }
+    tree.push_back(std::move(level));
+  }
+}
+
+size_t ResidueBasis::size() const {
+  return moduli.size();
+}
+
+size_t ResidueBasis::capacityBits() const {
+  return bits;
+}
+
+const std::vector<uint32_t>& ResidueBasis::primes() const {
+  return moduli;
+}
+
+const SuperLong& ResidueBasis::modulus() const {
+  return tree.back().front();
+}
+
+std::vector<uint32_t> ResidueBasis::reduce(const SuperLong& value) const {
+  detail::UntracedScope untraced;
+  SuperLong magnitude = value.isNegative() ? -value : value;
+  if (magnitude >= modulus()) {
+    magnitude = magnitude % modulus();
+  }
+  std::vector<uint32_t> residues(moduli.size());
+  remainderTree(tree.size() - 1, 0, magnitude, residues);
+  if (value.isNegative()) {
+    for (size_t i = 0; i < residues.size(); i++) {
+      residues[i] = (residues[i] == 0) ? 0 : moduli[i] - residues[i];
+    }
+  }
+  return residues;
+}
+
+// x = sum_i c_i * M / p_i (mod M) with c_i = r_i * inverses[i] mod p_i. The
+// sum is formed up the subproduct tree, and since it lies below
+// M * sum_i c_i / p_i, that fraction computed in floating point gives the
+// multiple of M to remove up to a final correction
+SuperLong ResidueBasis::reconstruct(const std::vector<uint32_t>& residues) const {
+  detail::UntracedScope untraced;
+  if (residues.size() != moduli.size()) {
+    throw std::invalid_argument("Residue count does not match the basis");
+  }
+  std::vector<uint32_t> scaled(moduli.size());
+  long double fraction = 0;
+  for (size_t i = 0; i < moduli.size(); i++) {
+    scaled[i] = static_cast<uint32_t>(static_cast<uint64_t>(residues[i] % moduli[i]) * inverses[i] % moduli[i]);
+    fraction += static_cast<long double>(scaled[i]) / moduli[i];
+  }
+
+  const SuperLong& m = modulus();
+  SuperLong result = combineTree(tree.size() - 1, 0, scaled);
+  result -= m * SuperLong {static_cast<int64_t>(std::floor(fraction))};
+  while (result.isNegative()) {
+    result += m;
+  }
+  while (result >= m) {
+    result -= m;
+  }
+  if ((result << 1) > m) {
+    result -= m;
+  }
+  return result;
+}
+
+void ResidueBasis::remainderTree(size_t level, size_t index, const SuperLong& value,
+                                 std::vector<uint32_t>& out) const {
+  if (level <= 1) {
+    // At most two 31-bit primes below, so the value fits in a word
+    uint64_t word = value.lowWord();
+    size_t first = index << level;
+    size_t last = std::min(first + (size_t {1} << level), moduli.size());
+    for (size_t i = first; i < last; i++) {
+      out[i] = static_cast<uint32_t>(word % moduli[i]);
+    }
+    return;
+  }
+  for (size_t child = 2 * index; child < std::min(2 * index + 2, tree[level - 1].size()); child++) {
+    const SuperLong& product = tree[level - 1][child];
+    remainderTree(level - 1, child, (value < product) ? value : value % product, out);
+  }
+}
+
+SuperLong ResidueBasis::combineTree(size_t level, size_t index, const std::vector<uint32_t>& scaled) const {
+  if (level == 0) {
+    return SuperLong {static_cast<int64_t>(scaled[index])};
+  }
+  size_t left = 2 * index;
+  size_t right = left + 1;
+  if (right >= tree[level - 1].size()) {
+    return combineTree(level - 1, left, scaled);
+  }
+  return combineTree(level - 1, left, scaled) * tree[level - 1][right] +
+         combineTree(level - 1, right, scaled) * tree[level - 1][left];
+}
+
+ResidueSuperLong::ResidueSuperLong(std::shared_ptr<const ResidueBasis> basis, const SuperLong& value)
+    : base(std::move(basis)) {
+  values = base->reduce(value);
+}
+
+ResidueSuperLong::ResidueSuperLong(std::shared_ptr<const ResidueBasis> basis, std::vector<uint32_t> residues)
+    : base(std::move(basis)), values(std::move(residues)) {
+}
+
+SuperLong ResidueSuperLong::toSuperLong() const {
+  detail::UntracedScope untraced;
+  return base->reconstruct(values);
+}
+
+ResidueSuperLong ResidueSuperLong::operator+(const ResidueSuperLong& other) const {
+  checkBasis(other);
+  const std::vector<uint32_t>& primes = base->primes();
+  std::vector<uint32_t> result(values.size());
+  for (size_t i = 0; i < values.size(); i++) {
+    uint32_t sum = values[i] + other.values[i];
+    result[i] = (sum >= primes[i]) ? sum - primes[i] : sum;
+  }
+  return ResidueSuperLong {base, std::move(result)};
+}
+
+ResidueSuperLong ResidueSuperLong::operator-(const ResidueSuperLong& other) const {
+  checkBasis(other);
+  const std::vector<uint32_t>& primes = base->primes();
+  std::vector<uint32_t> result(values.size());
+  for (size_t i = 0; i < values.size(); i++) {
+    uint32_t diff = values[i] + primes[i] - other.values[i];
+    result[i] = (diff >= primes[i]) ? diff - primes[i] : diff;
+  }
+  return ResidueSuperLong {base, std::move(result)};
+}
+
+ResidueSuperLong ResidueSuperLong::operator*(const ResidueSuperLong& other) const {
+  checkBasis(other);
+  const std::vector<uint32_t>& primes = base->primes();
+  std::vector<uint32_t> result(values.size());
+  for (size_t i = 0; i < values.size(); i++) {
+    result[i] = static_cast<uint32_t>(static_cast<uint64_t>(values[i]) * other.values[i] % primes[i]);
+  }
+  return ResidueSuperLong {base, std::move(result)};
+}
+
+ResidueSuperLong ResidueSuperLong::operator-() const {
+  const std::vector<uint32_t>& primes = base->primes();
+  std::vector<uint32_t> result(values.size());
+  for (size_t i = 0; i < values.size(); i++) {
+    result[i] = (values[i] == 0) ? 0 : primes[i] - values[i];
+  }
+  return ResidueSuperLong {base, std::move(result)};
+}
+
+ResidueSuperLong& ResidueSuperLong::operator+=(const ResidueSuperLong& other) {
+  return *this = *this + other;
+}
+
+ResidueSuperLong& ResidueSuperLong::operator-=(const ResidueSuperLong& other) {
+  return *this = *this - other;
+}
+
+ResidueSuperLong& ResidueSuperLong::operator*=(const ResidueSuperLong& other) {
+  return *this = *this * other;
+}
+
+bool ResidueSuperLong::operator==(const ResidueSuperLong& other) const {
+  checkBasis(other);
+  return values == other.values;
+}
+
+bool ResidueSuperLong::operator!=(const ResidueSuperLong& other) const {
+  return !(*this == other);
+}
+
+const ResidueBasis& ResidueSuperLong::basis() const {
+  return *base;
+}
+
+const std::vector<uint32_t>& ResidueSuperLong::residues() const {
+  return values;
+}
+
+void ResidueSuperLong::checkBasis(const ResidueSuperLong& other) const {
+  if (base != other.base) {
+    throw std::invalid_argument("Residue values use different bases");
+  }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "superlong.hpp"
+
+namespace aoi {
+
+  // A set of distinct 31-bit primes whose product M exceeds 2^(bits + 1), so
+  // that every integer of magnitude below 2^bits has a unique residue vector.
+  // Conversions walk a subproduct tree over the primes in both directions
+  class ResidueBasis {
+   public:
+    explicit ResidueBasis(size_t bits);
+
+    size_t size() const;
+    size_t capacityBits() const;
+    const std::vector<uint32_t>& primes() const;
+    const SuperLong& modulus() const;
+
+    std::vector<uint32_t> reduce(const SuperLong& value) const;
+    // Chinese remaindering into the symmetric range (-M/2, M/2]
+    SuperLong reconstruct(const std::vector<uint32_t>& residues) const;
+
+   private:
+    size_t bits;
+    std::vector<uint32_t> moduli;
+    // inverses[i] = (M / p_i)^-1 mod p_i
+    std::vector<uint32_t> inverses;
+    // tree[0] holds the primes, tree[k + 1][i] = tree[k][2i] * tree[k][2i + 1],
+    // and the last level is {M}
+    std::vector<std::vector<SuperLong>> tree;
+
+    void remainderTree(size_t level, size_t index, const SuperLong& value, std::vector<uint32_t>& out) const;
+    SuperLong combineTree(size_t level, size_t index, const std::vector<uint32_t>& scaled) const;
+  };
+
+  // An integer held as its residues modulo every prime of a ResidueBasis.
+  // Addition, subtraction and multiplication act on each residue on its own
+  // with no carries; results are exact as long as they stay within the
+  // basis capacity, which is not checked
+  class ResidueSuperLong {
+   public:
+    ResidueSuperLong(std::shared_ptr<const ResidueBasis> basis, const SuperLong& value);
+
+    SuperLong toSuperLong() const;
+
+    ResidueSuperLong operator+(const ResidueSuperLong& other) const;
+    ResidueSuperLong operator-(const ResidueSuperLong& other) const;
+    ResidueSuperLong operator*(const ResidueSuperLong& other) const;
+    ResidueSuperLong operator-() const;
+    ResidueSuperLong& operator+=(const ResidueSuperLong& other);
+    ResidueSuperLong& operator-=(const ResidueSuperLong& other);
+    ResidueSuperLong& operator*=(const ResidueSuperLong& other);
+
+    bool operator==(const ResidueSuperLong& other) const;
+    bool operator!=(const ResidueSuperLong& other) const;
+
+    const ResidueBasis& basis() const;
+    const std::vector<uint32_t>& residues() const;
+
+   private:
+    std::shared_ptr<const ResidueBasis> base;
+    std::vector<uint32_t> values;
+
+    ResidueSuperLong(std::shared_ptr<const ResidueBasis> basis, std::vector<uint32_t> residues);
+
+    void checkBasis(const ResidueSuperLong& other) const;
+  };
+
+}
@@ -0,0 +1,99 @@
+#include <cmath>
+#include <utility>
+
+#include "superfloat.hpp"
+#include "superlong-trace.hpp"
+
+using namespace aoi;
+
+// Working precision beyond the requested one, covering the few roundings
+// between the exact series sums and the final result
+static constexpr size_t kConstantGuardBits = 64;
+
+// Each Chudnovsky term contributes log2(640320^3 / 1728) ~ 47.11 bits
+static constexpr double kChudnovskyBitsPerTerm = 47.11;
+static constexpr int64_t kChudnovskyA = 13591409;
+static constexpr int64_t kChudnovskyB = 545140134;
+static constexpr int64_t kChudnovskyC3Over24 = 10939058860032000;
+
+// Term n of sum_n a(n) / b(n) * (p(0) ... p(n)) / (q(0) ... q(n))
+struct SeriesTerm {
+  SuperLong a, b, p, q;
+};
+
+struct SeriesSums {
+  SuperLong p, q, b, t;
+};
+
+// Haible-Papanikolaou binary splitting over terms [first, last): the sum
+// equals t / (b * q), and every product joins two halves of similar size,
+// which keeps the work in the fast multiplication tiers
+template <typename Term>
+static SeriesSums binarySplit(const Term& term, uint64_t first, uint64_t last) {
+  if (last - first == 1) {
+    SeriesTerm leaf = term(first);
+    SuperLong t = leaf.a * leaf.p;
+    return SeriesSums {std::move(leaf.p), std::move(leaf.q), std::move(leaf.b), std::move(t)};
+  }
+  uint64_t mid = first + (last - first) / 2;
+  SeriesSums left = binarySplit(term, first, mid);
+  SeriesSums right = binarySplit(term, mid, last);
+  SeriesSums result;
+  result.t = right.b * right.q * left.t + left.b * left.p * right.t;
+  result.p = left.p * right.p;
+  result.q = left.q * right.q;
+  result.b = left.b * right.b;
+  return result;
+}
+
+SuperFloat SuperFloat::pi(size_t precision) {
+  detail::UntracedScope untraced;
+  size_t working = precision + kConstantGuardBits;
+  uint64_t terms = static_cast<uint64_t>(working / kChudnovskyBitsPerTerm) + 2;
+  SeriesSums sums = binarySplit(
+      [](uint64_t n) {
+        if (n == 0) {
+          return SeriesTerm {SuperLong {kChudnovskyA}, SuperLong {1}, SuperLong {1}, SuperLong {1}};
+        }
+        int64_t k = static_cast<int64_t>(n);
+        SuperLong p = SuperLong {-(6 * k - 5)} * SuperLong {2 * k - 1} * SuperLong {6 * k - 1};
+        SuperLong q = SuperLong {k} * SuperLong {k} * SuperLong {k} * SuperLong {kChudnovskyC3Over24};
+        return SeriesTerm {SuperLong {kChudnovskyA + kChudnovskyB * k}, SuperLong {1}, std::move(p), std::move(q)};
+      },
+      0, terms);
+
+  // pi = 426880 * sqrt(10005) * q / t
+  SuperFloat root = SuperFloat {10005, working}.sqrt();
+  SuperFloat numerator = SuperFloat {sums.q * SuperLong {426880}, working} * root;
+  return (numerator / SuperFloat {sums.t, working}).withPrecision(precision);
+}
+
+SuperFloat SuperFloat::e(size_t precision) {
+  detail::UntracedScope untraced;
+  size_t working = precision + kConstantGuardBits;
+  uint64_t terms = 1;
+  for (double bits = 0; bits <= static_cast<double>(working); terms++) {
+    bits += std::log2(static_cast<double>(terms));
+  }
+  SeriesSums sums = binarySplit(
+      [](uint64_t n) {
+        SuperLong q {static_cast<int64_t>(n == 0 ? 1 : n)};
+        return SeriesTerm {SuperLong {1}, SuperLong {1}, SuperLong {1}, std::move(q)};
+      },
+      0, terms + 1);
+  return (SuperFloat {sums.t, working} / SuperFloat {sums.q, working}).withPrecision(precision);
+}
+
+// ln 2 = 2 atanh(1/3) = 2 sum_n 1 / ((2n + 1) 3^(2n + 1))
+SuperFloat SuperFloat::ln2(size_t precision) {
+  detail::UntracedScope untraced;
+  size_t working = precision + kConstantGuardBits;
+  uint64_t terms = static_cast<uint64_t>(working / std::log2(9.0)) + 2;
+  SeriesSums sums = binarySplit(
+      [](uint64_t n) {
+        SuperLong b {static_cast<int64_t>(2 * n + 1)};
+        return SeriesTerm {SuperLong {1}, std::move(b), SuperLong {1}, SuperLong {n == 0 ? 3 : 9}};
+      },
+      0, terms);
+  return (SuperFloat {sums.t << 1, working} / SuperFloat {sums.b * sums.q, working}).withPrecision(precision);
+}
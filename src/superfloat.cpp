@@ -0,0 +1,346 @@
+#include "superfloat.hpp"
+#include "superlong-trace.hpp"
+
+#include <algorithm>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+using namespace aoi;
+
+// Division and square root develop this many bits beyond the precision,
+// plus a sticky bit, so that a single rounding step is exact
+static constexpr size_t kGuardBits = 2;
+
+static SuperLong magnitude(const SuperLong& value) {
+  return value.isNegative() ? -value : value;
+}
+
+static SuperLong powerOfTen(size_t exponent) {
+  SuperLong result {1};
+  SuperLong base {10};
+  while (exponent > 0) {
+    if (exponent & 1) {
+      result *= base;
+    }
+    exponent >>= 1;
+    if (exponent > 0) {
+      base *= base;
+    }
+  }
+  return result;
+}
+
+SuperFloat::SuperFloat() : mant(), exp(0), prec(kDefaultPrecision) {
+}
+
+SuperFloat::SuperFloat(int64_t value, size_t precision) : mant(value), exp(0), prec(precision) {
+  detail::UntracedScope untraced;
+  round();
+}
+
+SuperFloat::SuperFloat(const SuperLong& value, size_t precision) : mant(value), exp(0), prec(precision) {
+  detail::UntracedScope untraced;
+  round();
+}
+
+SuperFloat::SuperFloat(SuperLong mantissa, int64_t exponent, size_t precision)
+    : mant(std::move(mantissa)), exp(exponent), prec(precision) {
+  round();
+}
+
+SuperFloat SuperFloat::fromParts(const SuperLong& mantissa, int64_t exponent, size_t precision) {
+  detail::UntracedScope untraced;
+  return SuperFloat {mantissa, exponent, precision};
+}
+
+SuperFloat SuperFloat::operator+(const SuperFloat& other) const {
+  return add(*this, other, false);
+}
+
+SuperFloat SuperFloat::operator-(const SuperFloat& other) const {
+  return add(*this, other, true);
+}
+
+SuperFloat SuperFloat::operator*(const SuperFloat& other) const {
+  detail::UntracedScope untraced;
+  return SuperFloat {mant * other.mant, exp + other.exp, std::max(prec, other.prec)};
+}
+
+// Produces at least precision + kGuardBits quotient bits and folds a
+// nonzero remainder into a sticky bit below them
+SuperFloat SuperFloat::operator/(const SuperFloat& other) const {
+  detail::UntracedScope untraced;
+  if (other.isZero()) {
+    throw std::invalid_argument("Division by zero");
+  }
+  size_t precision = std::max(prec, other.prec);
+  if (isZero()) {
+    return SuperFloat {SuperLong {}, 0, precision};
+  }
+  int64_t shift = static_cast<int64_t>(precision + kGuardBits + other.mant.bitLength()) -
+                  static_cast<int64_t>(mant.bitLength()) + 1;
+  shift = std::max<int64_t>(shift, 0);
+
+  auto [quotient, remainder] =
+      SuperLong::divide_quo_rem(magnitude(mant) << static_cast<size_t>(shift), magnitude(other.mant));
+  quotient = (quotient << 1) + SuperLong {remainder.isZero() ? 0 : 1};
+  if (mant.isNegative() != other.mant.isNegative()) {
+    quotient.negate();
+  }
+  return SuperFloat {std::move(quotient), exp - other.exp - shift - 1, precision};
+}
+
+SuperFloat SuperFloat::operator-() const {
+  detail::UntracedScope untraced;
+  SuperFloat result {*this};
+  result.mant.negate();
+  result.mant.removeLeadingZeros();
+  return result;
+}
+
+SuperFloat& SuperFloat::operator+=(const SuperFloat& other) {
+  return *this = *this + other;
+}
+
+SuperFloat& SuperFloat::operator-=(const SuperFloat& other) {
+  return *this = *this - other;
+}
+
+SuperFloat& SuperFloat::operator*=(const SuperFloat& other) {
+  return *this = *this * other;
+}
+
+SuperFloat& SuperFloat::operator/=(const SuperFloat& other) {
+  return *this = *this / other;
+}
+
+bool SuperFloat::operator==(const SuperFloat& other) const {
+  return exp == other.exp && mant == other.mant;
+}
+
+bool SuperFloat::operator!=(const SuperFloat& other) const {
+  return !(*this == other);
+}
+
+bool SuperFloat::operator<(const SuperFloat& other) const {
+  return compare(*this, other) < 0;
+}
+
+bool SuperFloat::operator<=(const SuperFloat& other) const {
+  return compare(*this, other) <= 0;
+}
+
+bool SuperFloat::operator>(const SuperFloat& other) const {
+  return compare(*this, other) > 0;
+}
+
+bool SuperFloat::operator>=(const SuperFloat& other) const {
+  return compare(*this, other) >= 0;
+}
+
+SuperFloat SuperFloat::sqrt() const {
+  detail::UntracedScope untraced;
+  if (isNegative()) {
+    throw std::invalid_argument("Square root of negative number");
+  }
+  if (isZero()) {
+    return *this;
+  }
+  int64_t shift = 2 * static_cast<int64_t>(prec + kGuardBits) - static_cast<int64_t>(mant.bitLength()) + 2;
+  shift = std::max<int64_t>(shift, 0);
+  if ((exp - shift) % 2 != 0) {
+    shift++;
+  }
+
+  SuperLong radicand = mant << static_cast<size_t>(shift);
+  SuperLong root = isqrt(radicand);
+  bool inexact = root * root != radicand;
+  root = (root << 1) + SuperLong {inexact ? 1 : 0};
+  return SuperFloat {std::move(root), (exp - shift) / 2 - 1, prec};
+}
+
+SuperFloat SuperFloat::withPrecision(size_t precision) const {
+  detail::UntracedScope untraced;
+  return SuperFloat {mant, exp, precision};
+}
+
+bool SuperFloat::isZero() const {
+  return mant.isZero();
+}
+
+bool SuperFloat::isNegative() const {
+  return mant.isNegative();
+}
+
+size_t SuperFloat::precision() const {
+  return prec;
+}
+
+const SuperLong& SuperFloat::mantissa() const {
+  return mant;
+}
+
+int64_t SuperFloat::exponent() const {
+  return exp;
+}
+
+SuperLong SuperFloat::toSuperLong() const {
+  detail::UntracedScope untraced;
+  if (exp >= 0) {
+    return mant << static_cast<size_t>(exp);
+  }
+  return mant >> static_cast<size_t>(-exp);
+}
+
+std::string SuperFloat::toString(size_t fractionDigits) const {
+  detail::UntracedScope untraced;
+  SuperLong scaled = magnitude(mant) * powerOfTen(fractionDigits);
+  if (exp >= 0) {
+    scaled <<= static_cast<size_t>(exp);
+  } else {
+    size_t shift = static_cast<size_t>(-exp);
+    scaled = (scaled + (SuperLong {1} << (shift - 1))) >> shift;
+  }
+
+  std::string digits = scaled.toString();
+  if (fractionDigits > 0) {
+    if (digits.size() <= fractionDigits) {
+      digits.insert(0, fractionDigits + 1 - digits.size(), '0');
+    }
+    digits.insert(digits.size() - fractionDigits, 1, '.');
+  }
+  if (isNegative() && !scaled.isZero()) {
+    digits.insert(0, 1, '-');
+  }
+  return digits;
+}
+
+// Rounds to nearest, ties to even, then strips trailing zero bits
+void SuperFloat::round() {
+  if (prec == 0) {
+    throw std::invalid_argument("Precision must be positive");
+  }
+  if (mant.isZero()) {
+    exp = 0;
+    return;
+  }
+  size_t bits = mant.bitLength();
+  if (bits > prec) {
+    size_t shift = bits - prec;
+    bool half = bitAt(mant, shift - 1);
+    bool sticky = anyBitBelow(mant, shift - 1);
+    bool negative = mant.isNegative();
+    mant >>= shift;
+    exp += static_cast<int64_t>(shift);
+    if (half && (sticky || bitAt(mant, 0))) {
+      mant += SuperLong {negative ? -1 : 1};
+    }
+  }
+  size_t zeros = trailingZeroBits(mant);
+  if (zeros > 0) {
+    mant >>= zeros;
+    exp += static_cast<int64_t>(zeros);
+  }
+}
+
+int SuperFloat::compare(const SuperFloat& a, const SuperFloat& b) {
+  detail::UntracedScope untraced;
+  if (a.isNegative() != b.isNegative()) {
+    return a.isNegative() ? -1 : 1;
+  }
+  if (a.isZero() || b.isZero()) {
+    if (a.isZero() && b.isZero()) {
+      return 0;
+    }
+    return (a.isZero() != b.isNegative()) ? -1 : 1;
+  }
+  int direction = a.isNegative() ? -1 : 1;
+  int64_t topA = a.exp + static_cast<int64_t>(a.mant.bitLength());
+  int64_t topB = b.exp + static_cast<int64_t>(b.mant.bitLength());
+  if (topA != topB) {
+    return (topA > topB) ? direction : -direction;
+  }
+  int64_t low = std::min(a.exp, b.exp);
+  SuperLong alignedA = a.mant << static_cast<size_t>(a.exp - low);
+  SuperLong alignedB = b.mant << static_cast<size_t>(b.exp - low);
+  if (alignedA == alignedB) {
+    return 0;
+  }
+  return (alignedA < alignedB) ? -1 : 1;
+}
+
+// Adds exactly after aligning exponents. An operand lying entirely below
+// the result's rounding position is first replaced by a single bit that
+// stays below it too, which rounds the same and keeps the alignment short
+SuperFloat SuperFloat::add(const SuperFloat& a, const SuperFloat& b, bool negateB) {
+  detail::UntracedScope untraced;
+  size_t precision = std::max(a.prec, b.prec);
+  SuperLong mantB = negateB ? -b.mant : b.mant;
+  if (b.isZero()) {
+    return SuperFloat {a.mant, a.exp, precision};
+  }
+  if (a.isZero()) {
+    return SuperFloat {std::move(mantB), b.exp, precision};
+  }
+
+  SuperLong bigMant = a.mant;
+  int64_t bigExp = a.exp;
+  SuperLong smallMant = std::move(mantB);
+  int64_t smallExp = b.exp;
+  int64_t bigTop = bigExp + static_cast<int64_t>(bigMant.bitLength());
+  int64_t smallTop = smallExp + static_cast<int64_t>(smallMant.bitLength());
+  if (smallTop > bigTop) {
+    std::swap(bigMant, smallMant);
+    std::swap(bigExp, smallExp);
+    std::swap(bigTop, smallTop);
+  }
+
+  int64_t floor = std::min(bigExp, bigTop - static_cast<int64_t>(precision) - 3);
+  if (smallTop <= floor - 1) {
+    smallMant = SuperLong {smallMant.isNegative() ? -1 : 1};
+    smallExp = floor - 2;
+  }
+
+  int64_t low = std::min(bigExp, smallExp);
+  SuperLong sum = (bigMant << static_cast<size_t>(bigExp - low)) + (smallMant << static_cast<size_t>(smallExp - low));
+  return SuperFloat {std::move(sum), low, precision};
+}
+
+size_t SuperFloat::trailingZeroBits(const SuperLong& value) {
+  if (value.isZero()) {
+    return 0;
+  }
+  size_t i = 0;
+  while (value.digits[i] == 0) {
+    i++;
+  }
+  size_t bits = i * 8;
+  for (n256 limb = value.digits[i]; (limb & 1) == 0; limb >>= 1) {
+    bits++;
+  }
+  return bits;
+}
+
+bool SuperFloat::bitAt(const SuperLong& value, size_t bit) {
+  size_t limb = bit / 8;
+  return limb < value.digits.size() && ((value.digits[limb] >> (bit % 8)) & 1) != 0;
+}
+
+bool SuperFloat::anyBitBelow(const SuperLong& value, size_t bit) {
+  size_t limb = std::min(bit / 8, value.digits.size());
+  for (size_t i = 0; i < limb; i++) {
+    if (value.digits[i] != 0) {
+      return true;
+    }
+  }
+  if (limb == value.digits.size()) {
+    return false;
+  }
+  return (value.digits[limb] & ((1u << (bit % 8)) - 1)) != 0;
+}
+
+std::ostream& aoi::operator<<(std::ostream& os, const SuperFloat& value) {
+  // Decimal digits carried by the mantissa: precision * log10(2)
+  return os << value.toString(value.precision() * 30103 / 100000);
+}
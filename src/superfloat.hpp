@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+#include "superlong.hpp"
+
+namespace aoi {
+
+  // Binary floating point value mantissa * 2^exponent with a SuperLong
+  // mantissa of at most precision() bits. Every operation rounds its exact
+  // result once, to nearest with ties to even, at the larger precision of its
+  // operands. Mantissas carry no trailing zero bits, so each value has one
+  // representation
+  class SuperFloat {
+   public:
+    static constexpr size_t kDefaultPrecision = 128;
+
+    SuperFloat();
+    SuperFloat(int64_t value, size_t precision = kDefaultPrecision);
+    SuperFloat(const SuperLong& value, size_t precision = kDefaultPrecision);
+
+    // Rounds mantissa * 2^exponent to the given precision
+    static SuperFloat fromParts(const SuperLong& mantissa, int64_t exponent, size_t precision = kDefaultPrecision);
+
+    SuperFloat operator+(const SuperFloat& other) const;
+    SuperFloat operator-(const SuperFloat& other) const;
+    SuperFloat operator*(const SuperFloat& other) const;
+    SuperFloat operator/(const SuperFloat& other) const;
+    SuperFloat operator-() const;
+    SuperFloat& operator+=(const SuperFloat& other);
+    SuperFloat& operator-=(const SuperFloat& other);
+    SuperFloat& operator*=(const SuperFloat& other);
+    SuperFloat& operator/=(const SuperFloat& other);
+
+    bool operator==(const SuperFloat& other) const;
+    bool operator!=(const SuperFloat& other) const;
+    bool operator<(const SuperFloat& other) const;
+    bool operator<=(const SuperFloat& other) const;
+    bool operator>(const SuperFloat& other) const;
+    bool operator>=(const SuperFloat& other) const;
+
+    SuperFloat sqrt() const;
+    SuperFloat withPrecision(size_t precision) const;
+
+    bool isZero() const;
+    bool isNegative() const;
+
+    size_t precision() const;
+    const SuperLong& mantissa() const;
+    int64_t exponent() const;
+
+    // Truncates toward zero
+    SuperLong toSuperLong() const;
+    // Fixed-point decimal with the given number of fraction digits, rounded
+    // to nearest with ties away from zero
+    std::string toString(size_t fractionDigits) const;
+
+    // Binary-splitting evaluations carried out with guard bits and rounded
+    // once to the requested precision
+    static SuperFloat pi(size_t precision);
+    static SuperFloat e(size_t precision);
+    static SuperFloat ln2(size_t precision);
+
+   private:
+    SuperLong mant;
+    int64_t exp;
+    size_t prec;
+
+    SuperFloat(SuperLong mantissa, int64_t exponent, size_t precision);
+
+    void round();
+
+    static int compare(const SuperFloat& a, const SuperFloat& b);
+    static SuperFloat add(const SuperFloat& a, const SuperFloat& b, bool negateB);
+    static size_t trailingZeroBits(const SuperLong& value);
+    static bool bitAt(const SuperLong& value, size_t bit);
+    static bool anyBitBelow(const SuperLong& value, size_t bit);
+  };
+
+  std::ostream& operator<<(std::ostream& os, const SuperFloat& value);
+
+}
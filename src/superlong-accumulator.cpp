@@ -0,0 +1,134 @@
+#include <algorithm>
+
+#include "superlong.hpp"
+#include "superlong-trace.hpp"
+
+using namespace aoi;
+
+static constexpr size_t kByteBits = 8;
+static constexpr uint64_t kByteMask = 0xFF;
+
+// Any limb stays at or below this bound, so settling can add a carry of at
+// most 2^56 to it without overflowing 64 bits
+static constexpr uint64_t kMaxLoad = uint64_t {1} << 63;
+
+// Products with both operands at least this long are formed with the
+// regular multiplication tiers and then added, instead of convolved in place
+static constexpr size_t kConvolveLimbs = 32;
+
+Accumulator::Accumulator() : positiveLoad(0), negativeLoad(0) {
+}
+
+Accumulator& Accumulator::operator+=(const SuperLong& value) {
+  add(value);
+  return *this;
+}
+
+Accumulator& Accumulator::operator-=(const SuperLong& value) {
+  subtract(value);
+  return *this;
+}
+
+void Accumulator::add(const SuperLong& value) {
+  if (value.isZero()) {
+    return;
+  }
+  bool toNegative = value.isNegative();
+  std::vector<uint64_t>& limbs = toNegative ? negative : positive;
+  reserveLoad(limbs, toNegative ? negativeLoad : positiveLoad, kByteMask);
+
+  if (limbs.size() < value.digits.size()) {
+    limbs.resize(value.digits.size(), 0);
+  }
+  for (size_t i = 0; i < value.digits.size(); i++) {
+    limbs[i] += value.digits[i];
+  }
+}
+
+void Accumulator::subtract(const SuperLong& value) {
+  SuperLong negated {value};
+  negated.negate();
+  negated.removeLeadingZeros();
+  add(negated);
+}
+
+void Accumulator::addProduct(const SuperLong& a, const SuperLong& b) {
+  detail::UntracedScope untraced;
+  if (a.isZero() || b.isZero()) {
+    return;
+  }
+  size_t shorter = std::min(a.digits.size(), b.digits.size());
+  if (shorter >= kConvolveLimbs) {
+    add(a * b);
+    return;
+  }
+
+  bool toNegative = a.isNegative() != b.isNegative();
+  std::vector<uint64_t>& limbs = toNegative ? negative : positive;
+  reserveLoad(limbs, toNegative ? negativeLoad : positiveLoad, kByteMask * kByteMask * shorter);
+
+  if (limbs.size() < a.digits.size() + b.digits.size()) {
+    limbs.resize(a.digits.size() + b.digits.size(), 0);
+  }
+  for (size_t i = 0; i < a.digits.size(); i++) {
+    uint64_t digitA = a.digits[i];
+    for (size_t j = 0; j < b.digits.size(); j++) {
+      limbs[i + j] += digitA * b.digits[j];
+    }
+  }
+}
+
+SuperLong Accumulator::value() const {
+  detail::UntracedScope untraced;
+  return settle(positive) - settle(negative);
+}
+
+void Accumulator::reset() {
+  positive.clear();
+  negative.clear();
+  positiveLoad = 0;
+  negativeLoad = 0;
+}
+
+void Accumulator::reserveLoad(std::vector<uint64_t>& limbs, uint64_t& load, uint64_t increment) {
+  if (load + increment > kMaxLoad) {
+    normalize(limbs);
+    load = kByteMask;
+  }
+  load += increment;
+}
+
+void Accumulator::normalize(std::vector<uint64_t>& limbs) {
+  uint64_t carry = 0;
+  for (uint64_t& limb : limbs) {
+    uint64_t sum = limb + carry;
+    limb = sum & kByteMask;
+    carry = sum >> kByteBits;
+  }
+  while (carry > 0) {
+    limbs.push_back(carry & kByteMask);
+    carry >>= kByteBits;
+  }
+}
+
+SuperLong Accumulator::settle(const std::vector<uint64_t>& limbs) {
+  SuperLong result;
+  if (limbs.empty()) {
+    return result;
+  }
+  result.digits.clear();
+  result.digits.reserve(limbs.size() + sizeof(uint64_t));
+
+  uint64_t carry = 0;
+  for (uint64_t limb : limbs) {
+    uint64_t sum = limb + carry;
+    result.digits.push_back(static_cast<n256>(sum & kByteMask));
+    carry = sum >> kByteBits;
+  }
+  while (carry > 0) {
+    result.digits.push_back(static_cast<n256>(carry & kByteMask));
+    carry >>= kByteBits;
+  }
+  result.removeLeadingZeros();
+  return result;
+}
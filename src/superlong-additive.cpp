@@ -1,21 +1,34 @@
 #include "superlong.hpp"
+#include "superlong-trace.hpp"
 
 using namespace aoi;
 
 SuperLong SuperLong::operator+(const SuperLong& other) const {
+  detail::TraceScope trace {TraceOp::Add, *this, &other};
   return add(*this, other);
 }
 
 SuperLong SuperLong::operator-(const SuperLong& other) const {
+  detail::TraceScope trace {TraceOp::Subtract, *this, &other};
   return subtract(*this, other);
 }
 
+SuperLong SuperLong::operator-() const {
+  SuperLong result {*this};
+  if (!result.isZero()) {
+    result.negate();
+  }
+  return result;
+}
+
 SuperLong& SuperLong::operator+=(const SuperLong& other) {
+  detail::TraceScope trace {TraceOp::Add, *this, &other};
   *this = add(*this, other);
   return *this;
 }
 
 SuperLong& SuperLong::operator-=(const SuperLong& other) {
+  detail::TraceScope trace {TraceOp::Subtract, *this, &other};
   *this = subtract(*this, other);
   return *this;
 }
@@ -69,11 +82,11 @@ SuperLong SuperLong::add(const SuperLong& a, const SuperLong& b) {
 
 SuperLong SuperLong::addAbs(const SuperLong& a, const SuperLong& b) {
   SuperLong result;
-  result.digits.clear();  // Clear the default [0]
   n256plus carry = 0;
 
   size_t maxSize = std::max(a.digits.size(), b.digits.size());
-  result.digits.reserve(maxSize + 1);
+  result.digits.assign(maxSize + 1, 0);
+  n256* out = result.digits.data();
 
   for (size_t i = 0; i < maxSize; ++i) {
     n256 digitA = (i < a.digits.size()) ? a.digits[i] : 0;
@@ -81,12 +94,10 @@ SuperLong SuperLong::addAbs(const SuperLong& a, const SuperLong& b) {
 
     n256plus sum = static_cast<n256plus>(digitA) + static_cast<n256plus>(digitB) + static_cast<n256plus>(carry);
 
-    result.digits.push_back(static_cast<n256>(sum % 256));
+    out[i] = static_cast<n256>(sum % 256);
     carry = static_cast<n256plus>(sum / 256);
   }
-  if (carry > 0) {
-    result.digits.push_back(static_cast<n256>(carry));
-  }
+  out[maxSize] = static_cast<n256>(carry);
   result.removeLeadingZeros();
 
   return result;
@@ -106,10 +117,10 @@ int SuperLong::abscmp(const SuperLong& a, const SuperLong& b) {
 
 SuperLong SuperLong::subtractAbs(const SuperLong& a, const SuperLong& b) {
   SuperLong result;
-  result.digits.clear();
   n256plus borrow = 0;
 
-  result.digits.reserve(a.digits.size());
+  result.digits.assign(a.digits.size(), 0);
+  n256* out = result.digits.data();
 
   for (size_t i = 0; i < a.digits.size(); ++i) {
     n256 digitA = a.digits[i];
@@ -118,10 +129,10 @@ SuperLong SuperLong::subtractAbs(const SuperLong& a, const SuperLong& b) {
     int16_t diff = static_cast<int16_t>(digitA) - static_cast<int16_t>(digitB) - static_cast<int16_t>(borrow);
 
     if (diff >= 0) {
-      result.digits.push_back(static_cast<n256>(diff));
+      out[i] = static_cast<n256>(diff);
       borrow = 0;
     } else {
-      result.digits.push_back(static_cast<n256>(diff + 256));
+      out[i] = static_cast<n256>(diff + 256);
       borrow = 1;
     }
   }
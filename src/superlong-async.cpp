@@ -0,0 +1,103 @@
+#include "superlong-async.hpp"
+
+#include <utility>
+
+using namespace aoi;
+
+// The deadline is only read every this many checkpoints, so the common case
+// stays a thread-local load and an atomic flag test
+static constexpr unsigned kDeadlineCheckInterval = 64;
+
+static thread_local const detail::CancellationState* currentState = nullptr;
+static thread_local unsigned currentDepth = 0;
+static thread_local unsigned checkpointTicks = 0;
+
+CancellationToken::CancellationToken() : state(std::make_shared<detail::CancellationState>()) {
+}
+
+void CancellationToken::cancel() {
+  state->cancelled.store(true, std::memory_order_relaxed);
+}
+
+bool CancellationToken::isCancelled() const {
+  return state->cancelled.load(std::memory_order_relaxed);
+}
+
+void CancellationToken::setDeadline(Clock::time_point deadline) {
+  state->deadline.store(deadline.time_since_epoch().count(), std::memory_order_relaxed);
+}
+
+bool CancellationToken::isExpired() const {
+  return Clock::now().time_since_epoch().count() >= state->deadline.load(std::memory_order_relaxed);
+}
+
+void CancellationToken::setProgressCallback(std::function<void(double)> callback) {
+  state->progress = std::move(callback);
+}
+
+CancellationBinding::CancellationBinding(const CancellationToken& token)
+    : state(token.state), previous(currentState) {
+  currentState = state.get();
+}
+
+CancellationBinding::~CancellationBinding() {
+  currentState = previous;
+}
+
+void detail::checkpoint() {
+  const detail::CancellationState* state = currentState;
+  if (state == nullptr) {
+    return;
+  }
+  if (state->cancelled.load(std::memory_order_relaxed)) {
+    throw OperationCancelled("Operation cancelled");
+  }
+  if (++checkpointTicks % kDeadlineCheckInterval == 0 &&
+      CancellationToken::Clock::now().time_since_epoch().count() >= state->deadline.load(std::memory_order_relaxed)) {
+    throw OperationCancelled("Operation deadline exceeded");
+  }
+}
+
+detail::OperationScope::OperationScope() : outermost(currentDepth++ == 0) {
+}
+
+detail::OperationScope::~OperationScope() {
+  currentDepth--;
+}
+
+void detail::OperationScope::progress(double fraction) const {
+  const detail::CancellationState* state = currentState;
+  if (outermost && state != nullptr && state->progress) {
+    state->progress(fraction);
+  }
+}
+
+template <typename Result, typename Operation>
+static std::future<Result> launch(CancellationToken token, Operation operation) {
+  return std::async(std::launch::async, [token = std::move(token), operation = std::move(operation)]() {
+    if (token.isCancelled()) {
+      throw OperationCancelled("Operation cancelled");
+    }
+    if (token.isExpired()) {
+      throw OperationCancelled("Operation deadline exceeded");
+    }
+    CancellationBinding binding {token};
+    return operation();
+  });
+}
+
+std::future<SuperLong> aoi::multiplyAsync(SuperLong a, SuperLong b, CancellationToken token) {
+  return launch<SuperLong>(std::move(token), [a = std::move(a), b = std::move(b)] { return a * b; });
+}
+
+std::future<SuperLong> aoi::divideAsync(SuperLong a, SuperLong b, CancellationToken token) {
+  return launch<SuperLong>(std::move(token), [a = std::move(a), b = std::move(b)] { return a / b; });
+}
+
+std::future<SuperLong> aoi::modAsync(SuperLong a, SuperLong b, CancellationToken token) {
+  return launch<SuperLong>(std::move(token), [a = std::move(a), b = std::move(b)] { return a % b; });
+}
+
+std::future<std::string> aoi::toStringAsync(SuperLong value, CancellationToken token) {
+  return launch<std::string>(std::move(token), [value = std::move(value)] { return value.toString(); });
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include "superlong.hpp"
+
+namespace aoi {
+
+  // Thrown out of a long-running operation (and so out of future::get())
+  // once its token is cancelled or its deadline has passed
+  class OperationCancelled : public std::runtime_error {
+   public:
+    using std::runtime_error::runtime_error;
+  };
+
+  namespace detail {
+
+    struct CancellationState {
+      std::atomic<bool> cancelled {false};
+      std::atomic<std::chrono::steady_clock::rep> deadline {
+          std::chrono::steady_clock::time_point::max().time_since_epoch().count()};
+      std::function<void(double)> progress;
+    };
+
+  }
+
+  // Shared handle: copies observe and control the same operation. The
+  // progress callback runs on the worker thread with a fraction in [0, 1]
+  // and must be set before the operation starts
+  class CancellationToken {
+   public:
+    using Clock = std::chrono::steady_clock;
+
+    CancellationToken();
+
+    void cancel();
+    bool isCancelled() const;
+
+    void setDeadline(Clock::time_point deadline);
+    bool isExpired() const;
+
+    void setProgressCallback(std::function<void(double)> callback);
+
+   private:
+    friend class CancellationBinding;
+
+    std::shared_ptr<detail::CancellationState> state;
+  };
+
+  // Makes a token current for the calling thread for the lifetime of the
+  // binding, so the checkpoints inside the arithmetic kernels observe it
+  class CancellationBinding {
+   public:
+    explicit CancellationBinding(const CancellationToken& token);
+    ~CancellationBinding();
+
+    CancellationBinding(const CancellationBinding&) = delete;
+    CancellationBinding& operator=(const CancellationBinding&) = delete;
+
+   private:
+    std::shared_ptr<detail::CancellationState> state;
+    const detail::CancellationState* previous;
+  };
+
+  std::future<SuperLong> multiplyAsync(SuperLong a, SuperLong b, CancellationToken token = {});
+  std::future<SuperLong> divideAsync(SuperLong a, SuperLong b, CancellationToken token = {});
+  std::future<SuperLong> modAsync(SuperLong a, SuperLong b, CancellationToken token = {});
+  std::future<std::string> toStringAsync(SuperLong value, CancellationToken token = {});
+
+  namespace detail {
+
+    // Throws OperationCancelled if the thread's current token asks for it;
+    // a no-op costing one thread-local load when no token is bound
+    void checkpoint();
+
+    // Tracks nesting of instrumented kernels so that only the outermost one
+    // reports progress
+    class OperationScope {
+     public:
+      OperationScope();
+      ~OperationScope();
+
+      OperationScope(const OperationScope&) = delete;
+      OperationScope& operator=(const OperationScope&) = delete;
+
+      void progress(double fraction) const;
+
+     private:
+      bool outermost;
+    };
+
+  }
+
+}
@@ -1,14 +1,19 @@
 #include "superlong.hpp"
+#include "superlong-trace.hpp"
 
-#include <algorithm>
+#include <charconv>
 #include <climits>
 #include <cstdint>
+#include <cstring>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 
 using namespace aoi;
 
+static constexpr size_t kDecimalChunkDigits = 9;
+
 SuperLong::SuperLong() : sign(Sign::Positive), digits(1, 0) {
 }
 
@@ -18,6 +23,10 @@ SuperLong::SuperLong(const SuperLong& other) : sign(other.sign), digits(other.di
 SuperLong::SuperLong(SuperLong&& other) noexcept : sign(other.sign), digits(std::move(other.digits)) {
 }
 
+SuperLong::SuperLong(Sign sign, const n256* limbs, size_t count) : sign(sign), digits(limbs, limbs + count) {
+  removeLeadingZeros();
+}
+
 SuperLong& SuperLong::operator=(const SuperLong& other) {
   if (this != &other) {
     sign = other.sign;
@@ -34,54 +43,75 @@ SuperLong& SuperLong::operator=(SuperLong&& other) noexcept {
   return *this;
 }
 
-SuperLong::SuperLong(const std::string& str) {
+SuperLong::SuperLong(std::string_view str) : sign(Sign::Positive), digits(1, 0) {
   if (str.empty()) {
     throw std::invalid_argument("Input string cannot be empty");
   }
-
-  size_t start = 0;
-  if (str[0] == '-') {
-    sign = Sign::Negative;
-    start = 1;
-  } else {
-    sign = Sign::Positive;
-    if (str[0] == '+') {
-      start = 1;
-    }
-  }
-  std::string strc = str.substr(start);
-
-  if (strc.empty()) {
+  if (str.size() == 1 && (str[0] == '-' || str[0] == '+')) {
     throw std::invalid_argument("Input string cannot be just a sign");
   }
-  for (char c : strc) {
-    if (c < '0' || c > '9') {
-      throw std::invalid_argument("Input string contains non-digit characters");
-    }
+  const char* last = str.data() + str.size();
+  std::from_chars_result parsed = from_chars(str.data(), last, *this);
+  if (parsed.ec != std::errc {} || parsed.ptr != last) {
+    throw std::invalid_argument("Input string contains non-digit characters");
   }
-  if (strc == "0") {
-    digits.push_back(0);
-    sign = Sign::Positive;
-    return;
+}
+
+// True when all eight bytes are ASCII digits: each byte must have a high
+// nibble of 3 both before and after adding 6
+static bool isEightDigits(const char* p) {
+  uint64_t block;
+  std::memcpy(&block, p, sizeof(block));
+  return ((block & 0xF0F0F0F0F0F0F0F0) | (((block + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ==
+         0x3333333333333333;
+}
+
+static size_t digitPrefixLength(const char* first, const char* last) {
+  const char* p = first;
+  while (last - p >= 8 && isEightDigits(p)) {
+    p += 8;
   }
+  while (p != last && *p >= '0' && *p <= '9') {
+    p++;
+  }
+  return static_cast<size_t>(p - first);
+}
 
-  while (!strc.empty()) {
-    n256plus remainder = 0;
-    std::string new_str;
+// Accepts an optional '+' or '-' like the string constructor, then takes the
+// longest run of decimal digits. The only allocation is the result's limbs
+std::from_chars_result aoi::from_chars(const char* first, const char* last, SuperLong& value) {
+  detail::UntracedScope untraced;
+  const char* p = first;
+  Sign parsedSign = Sign::Positive;
+  if (p != last && (*p == '-' || *p == '+')) {
+    parsedSign = (*p == '-') ? Sign::Negative : Sign::Positive;
+    p++;
+  }
+  size_t count = digitPrefixLength(p, last);
+  if (count == 0) {
+    return {first, std::errc::invalid_argument};
+  }
 
-    for (size_t i = 0; i < strc.size(); i++) {
-      n256plus value = remainder * 10 + (strc[i] - '0');
-      if (value / 256 != 0 || i > 0 || !new_str.empty()) {
-        new_str += static_cast<char>('0' + (value / 256));
-      }
-      remainder = value % 256;
+  value.digits.clear();
+  value.digits.reserve(count * 415 / 1000 + 2);  // log256(10) < 0.415
+  value.digits.push_back(0);
+
+  size_t head = count % kDecimalChunkDigits;
+  for (size_t pos = 0; pos < count;) {
+    size_t take = (pos == 0 && head > 0) ? head : kDecimalChunkDigits;
+    uint32_t chunk = 0;
+    uint32_t scale = 1;
+    for (size_t i = 0; i < take; i++) {
+      chunk = chunk * 10 + static_cast<uint32_t>(p[pos + i] - '0');
+      scale *= 10;
     }
-
-    digits.push_back(static_cast<n256>(remainder));
-    strc = new_str;
+    value.mulAddSmall(scale, chunk);
+    pos += take;
   }
 
-  removeLeadingZeros();
+  value.sign = parsedSign;
+  value.removeLeadingZeros();
+  return {p + count, std::errc {}};
 }
 
 void SuperLong::initFromUint64(uint64_t num) {
@@ -98,7 +128,7 @@ void SuperLong::initFromUint64(uint64_t num) {
 SuperLong::SuperLong(int64_t num) {
   if (num == INT64_MIN) {
     sign = Sign::Negative;
-    digits = std::vector<n256> {0, 0, 0, 0, 0, 0, 0, 128};  // 2^63 in little-endian
+    digits = LimbBuffer {0, 0, 0, 0, 0, 0, 0, 128};  // 2^63 in little-endian
     return;
   }
   if (num < 0) {
@@ -111,26 +141,10 @@ SuperLong::SuperLong(int64_t num) {
 }
 
 std::string SuperLong::toString() const {
-  if (isZero()) {
-    return "0";
-  }
-  std::string result;
-
-  SuperLong temp {*this};
-  temp.sign = Sign::Positive;
-
-  while (!temp.isZero()) {
-    auto [quotient, remainder] = divide_quo_rem(temp, SuperLong(10LL));
-    temp = quotient;
-    result += static_cast<char>(remainder.digits[0] + '0');
-  }
-  if (sign == Sign::Negative) {
-    result += '-';
-  }
-  std::reverse(result.begin(), result.end());
-  return result;
+  detail::TraceScope trace {TraceOp::ToString, *this};
+  return toString(10);
 }
 
 SuperLong aoi::operator"" _sl(const char* str, size_t len) {
-  return SuperLong {std::string(str, len)};
+  return SuperLong {std::string_view(str, len)};
 }
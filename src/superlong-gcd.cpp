@@ -0,0 +1,253 @@
+#include <array>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#include "superlong.hpp"
+#include "superlong-trace.hpp"
+
+using namespace aoi;
+
+static constexpr size_t kNativeGcdBits = 64;
+static constexpr size_t kLehmerDigitBits = 32;
+// From this size on, gcd and xgcd reduce by recursive half-GCD
+static constexpr size_t kHalfGcdBits = 4096;
+
+// Row-major 2x2 matrix taking (a, b) to (t[0] a + t[1] b, t[2] a + t[3] b)
+using GcdMatrix = std::array<SuperLong, 4>;
+
+struct LehmerMatrix {
+  int64_t a, b, c, d;
+};
+
+// Knuth's Algorithm L on the leading digits: collects Euclid quotients for
+// as long as they are guaranteed to match the quotients of the full values
+static LehmerMatrix lehmerMatrix(int64_t ahat, int64_t bhat) {
+  LehmerMatrix m {1, 0, 0, 1};
+  while (bhat + m.c > 0 && bhat + m.d > 0 && ahat + m.a >= 0 && ahat + m.b >= 0) {
+    int64_t q = (ahat + m.a) / (bhat + m.c);
+    if (q != (ahat + m.b) / (bhat + m.d)) {
+      break;
+    }
+    int64_t t = m.a - q * m.c;
+    m.a = m.c;
+    m.c = t;
+    t = m.b - q * m.d;
+    m.b = m.d;
+    m.d = t;
+    t = ahat - q * bhat;
+    ahat = bhat;
+    bhat = t;
+  }
+  return m;
+}
+
+static uint64_t binaryGcdU64(uint64_t u, uint64_t v) {
+  if (u == 0 || v == 0) {
+    return u | v;
+  }
+  int shift = 0;
+  while (((u | v) & 1) == 0) {
+    u >>= 1;
+    v >>= 1;
+    shift++;
+  }
+  while ((u & 1) == 0) {
+    u >>= 1;
+  }
+  do {
+    while ((v & 1) == 0) {
+      v >>= 1;
+    }
+    if (u > v) {
+      std::swap(u, v);
+    }
+    v -= u;
+  } while (v != 0);
+  return u << shift;
+}
+
+static SuperLong absValue(const SuperLong& value) {
+  return value.isNegative() ? SuperLong {} - value : value;
+}
+
+static GcdMatrix identityMatrix() {
+  return {SuperLong {1}, SuperLong {}, SuperLong {}, SuperLong {1}};
+}
+
+// The matrix that applies `first` and then `second`
+static GcdMatrix compose(const GcdMatrix& second, const GcdMatrix& first) {
+  return {second[0] * first[0] + second[1] * first[2], second[0] * first[1] + second[1] * first[3],
+          second[2] * first[0] + second[3] * first[2], second[2] * first[1] + second[3] * first[3]};
+}
+
+static void applyMatrix(const GcdMatrix& t, SuperLong& a, SuperLong& b) {
+  SuperLong na = t[0] * a + t[1] * b;
+  SuperLong nb = t[2] * a + t[3] * b;
+  a = std::move(na);
+  b = std::move(nb);
+}
+
+// Restores a >= b >= 0 after applying a matrix found on truncated values.
+// Negating or swapping rows keeps the determinant +-1, so the gcd and the
+// cofactors carried by t stay exact even where a late quotient was wrong
+static void normalize(GcdMatrix& t, SuperLong& a, SuperLong& b) {
+  if (a.isNegative()) {
+    a = -a;
+    t[0] = -t[0];
+    t[1] = -t[1];
+  }
+  if (b.isNegative()) {
+    b = -b;
+    t[2] = -t[2];
+    t[3] = -t[3];
+  }
+  if (a < b) {
+    std::swap(a, b);
+    std::swap(t[0], t[2]);
+    std::swap(t[1], t[3]);
+  }
+}
+
+// One Lehmer step on u >= v > 0: the quotients that the leading 32 bits
+// determine, or a single division when they determine none. Returns the
+// matrix applied to (u, v)
+std::array<SuperLong, 4> SuperLong::lehmer_step(SuperLong& u, SuperLong& v) {
+  size_t shift = u.bitLength() - std::min(u.bitLength(), kLehmerDigitBits);
+  LehmerMatrix m = lehmerMatrix(static_cast<int64_t>((u >> shift).lowWord()),
+                                static_cast<int64_t>((v >> shift).lowWord()));
+  if (m.b == 0) {
+    auto [q, r] = divide_quo_rem(u, v);
+    u = std::move(v);
+    v = std::move(r);
+    return {SuperLong {}, SuperLong {1}, SuperLong {1}, -q};
+  }
+  SuperLong nu = u * m.a + v * m.b;
+  SuperLong nv = u * m.c + v * m.d;
+  u = std::move(nu);
+  v = std::move(nv);
+  return {SuperLong {m.a}, SuperLong {m.b}, SuperLong {m.c}, SuperLong {m.d}};
+}
+
+// Reduces a >= b >= 0 of n bits in place until b has at most n / 2 + 1
+// bits, and returns the unimodular matrix applied. The quotients of the top
+// half of the bits are found recursively on a and b shifted down, which
+// brings b to about 3n / 4 bits; a second recursion on the top of what is
+// left reaches n / 2. Each level costs a few multiplications, so the whole
+// reduction is O(M(n) log n) instead of the quadratic Lehmer loop
+std::array<SuperLong, 4> SuperLong::half_gcd(SuperLong& a, SuperLong& b) {
+  size_t n = a.bitLength();
+  size_t target = n / 2 + 1;
+  GcdMatrix t = identityMatrix();
+
+  if (n >= kHalfGcdBits && b.bitLength() > target) {
+    SuperLong topA = a >> target;
+    SuperLong topB = b >> target;
+    t = half_gcd(topA, topB);
+    applyMatrix(t, a, b);
+    normalize(t, a, b);
+
+    if (b.bitLength() > target) {
+      t = compose(lehmer_step(a, b), t);
+    }
+    size_t length = a.bitLength();
+    if (b.bitLength() > target && length < 2 * target) {
+      size_t shift = 2 * target - length;
+      topA = a >> shift;
+      topB = b >> shift;
+      GcdMatrix second = half_gcd(topA, topB);
+      applyMatrix(second, a, b);
+      normalize(second, a, b);
+      t = compose(second, t);
+    }
+  }
+
+  while (b.bitLength() > target) {
+    t = compose(lehmer_step(a, b), t);
+  }
+  return t;
+}
+
+// Half-GCD pays off only while the values are balanced; a much shorter v is
+// first brought up by a division
+static bool useHalfGcd(const SuperLong& u, const SuperLong& v) {
+  return v.bitLength() >= kHalfGcdBits && 2 * v.bitLength() > u.bitLength() + 2;
+}
+
+SuperLong aoi::gcd(const SuperLong& a, const SuperLong& b) {
+  detail::UntracedScope untraced;
+  SuperLong u = absValue(a);
+  SuperLong v = absValue(b);
+  if (u < v) {
+    std::swap(u, v);
+  }
+
+  while (v.bitLength() > kNativeGcdBits) {
+    if (useHalfGcd(u, v)) {
+      SuperLong::half_gcd(u, v);
+    } else {
+      SuperLong::lehmer_step(u, v);
+    }
+  }
+  if (v.isZero()) {
+    return u;
+  }
+  if (u.bitLength() > kNativeGcdBits) {
+    u %= v;
+  }
+
+  SuperLong result;
+  result.digits.clear();
+  result.initFromUint64(binaryGcdU64(u.lowWord(), v.lowWord()));
+  return result;
+}
+
+std::tuple<SuperLong, SuperLong, SuperLong> aoi::xgcd(const SuperLong& a, const SuperLong& b) {
+  detail::UntracedScope untraced;
+  if (b.isZero()) {
+    return {absValue(a), SuperLong {a.isNegative() ? -1 : 1}, SuperLong {}};
+  }
+
+  // Invariant: u = su * |a| (mod |b|) and v = sv * |a| (mod |b|)
+  SuperLong u = absValue(a);
+  SuperLong v = absValue(b);
+  SuperLong su {1};
+  SuperLong sv {};
+  if (u < v) {
+    std::swap(u, v);
+    std::swap(su, sv);
+  }
+
+  while (!v.isZero()) {
+    GcdMatrix step = useHalfGcd(u, v) ? SuperLong::half_gcd(u, v) : SuperLong::lehmer_step(u, v);
+    applyMatrix(step, su, sv);
+  }
+
+  if (a.isNegative()) {
+    su.negate();
+    su.removeLeadingZeros();
+  }
+  SuperLong t = divexact(u - su * a, b);
+  return {u, su, t};
+}
+
+SuperLong aoi::modinv(const SuperLong& a, const SuperLong& m) {
+  detail::UntracedScope untraced;
+  if (!m.isPositive() || m.isZero()) {
+    throw std::invalid_argument("Modulus must be positive");
+  }
+  SuperLong reduced = a % m;
+  if (reduced.isNegative()) {
+    reduced += m;
+  }
+
+  auto [g, x, y] = xgcd(reduced, m);
+  if (g != SuperLong {1}) {
+    throw std::invalid_argument("Value is not invertible modulo m");
+  }
+  x %= m;
+  if (x.isNegative()) {
+    x += m;
+  }
+  return x;
+}
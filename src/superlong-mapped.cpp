@@ -0,0 +1,377 @@
+#include "superlong-mapped.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace aoi;
+
+static constexpr size_t kHeader = SuperLong::kSerialHeaderSize;
+static constexpr uint8_t kHeaderPositive = 0;
+static constexpr uint8_t kHeaderNegative = 1;
+
+// Addition keeps three windows mapped at once; multiplication holds two
+// operand blocks, their product and the multiplier's temporaries, which
+// together stay within about this many block lengths
+static constexpr size_t kAddWindows = 3;
+static constexpr size_t kMultiplyBlocks = 16;
+
+// Leading zero limbs are found by reading back from the top in this size
+static constexpr size_t kTrimBuffer = 4096;
+
+static size_t pageSize() {
+  static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  return size;
+}
+
+// Largest page multiple within budget / parts, and at least one page
+static size_t windowLimbs(size_t budget, size_t parts) {
+  size_t page = pageSize();
+  return std::max(page, budget / parts / page * page);
+}
+
+// Maps the byte range [offset, offset + length) of a file, aligning the
+// mapping itself down to a page boundary
+class MappedWindow {
+ public:
+  MappedWindow(int fd, size_t offset, size_t length, bool writable) : base(nullptr), mapped(0), skew(0) {
+    if (length == 0) {
+      return;
+    }
+    skew = offset % pageSize();
+    mapped = length + skew;
+    int protection = writable ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    base = mmap(nullptr, mapped, protection, MAP_SHARED, fd, static_cast<off_t>(offset - skew));
+    if (base == MAP_FAILED) {
+      throw std::runtime_error("Failed to map file");
+    }
+  }
+
+  ~MappedWindow() {
+    if (base != nullptr) {
+      munmap(base, mapped);
+    }
+  }
+
+  MappedWindow(const MappedWindow&) = delete;
+  MappedWindow& operator=(const MappedWindow&) = delete;
+
+  n256* data() const {
+    return static_cast<n256*>(base) + skew;
+  }
+
+ private:
+  void* base;
+  size_t mapped;
+  size_t skew;
+};
+
+// Streams out = x + y (or x - y, with |x| >= |y|) over n limbs one window
+// at a time and returns the final carry
+static n256plus combineLimbs(int fdX, size_t countX, int fdY, size_t countY, int fdOut, size_t n, bool subtractY,
+                             size_t chunk) {
+  n256plus carry = 0;
+  for (size_t offset = 0; offset < n; offset += chunk) {
+    size_t length = std::min(chunk, n - offset);
+    size_t lengthX = (offset < countX) ? std::min(length, countX - offset) : 0;
+    size_t lengthY = (offset < countY) ? std::min(length, countY - offset) : 0;
+    MappedWindow x {fdX, kHeader + offset, lengthX, false};
+    MappedWindow y {fdY, kHeader + offset, lengthY, false};
+    MappedWindow out {fdOut, kHeader + offset, length, true};
+
+    for (size_t i = 0; i < length; i++) {
+      n256plus digitX = (i < lengthX) ? x.data()[i] : 0;
+      n256plus digitY = (i < lengthY) ? y.data()[i] : 0;
+      if (subtractY) {
+        n256plus subtrahend = digitY + carry;
+        carry = (digitX < subtrahend) ? 1 : 0;
+        out.data()[i] = static_cast<n256>(digitX + (carry << 8) - subtrahend);
+      } else {
+        n256plus sum = digitX + digitY + carry;
+        out.data()[i] = static_cast<n256>(sum & 0xFF);
+        carry = sum >> 8;
+      }
+    }
+  }
+  return carry;
+}
+
+// Adds `length` limbs into the file at limb `offset`, carrying as far as needed
+static void accumulateLimbs(int fd, size_t offset, const n256* src, size_t length, size_t capacity, size_t chunk) {
+  n256plus carry = 0;
+  size_t pos = 0;
+  while ((pos < length || carry > 0) && offset + pos < capacity) {
+    size_t span = (pos < length) ? std::min(chunk, length - pos) : std::min(chunk, capacity - offset - pos);
+    MappedWindow out {fd, kHeader + offset + pos, span, true};
+    for (size_t i = 0; i < span; i++) {
+      if (pos + i >= length && carry == 0) {
+        return;
+      }
+      n256plus sum = out.data()[i] + carry + ((pos + i < length) ? src[pos + i] : 0);
+      out.data()[i] = static_cast<n256>(sum & 0xFF);
+      carry = sum >> 8;
+    }
+    pos += span;
+  }
+}
+
+MappedSuperLong::MappedSuperLong(std::string path, int fd, Sign sign, size_t count)
+    : filePath(std::move(path)), fd(fd), sign(sign), count(count) {
+}
+
+MappedSuperLong::MappedSuperLong(MappedSuperLong&& other) noexcept
+    : filePath(std::move(other.filePath)),
+      targetPath(std::move(other.targetPath)),
+      fd(other.fd),
+      sign(other.sign),
+      count(other.count) {
+  other.fd = -1;
+  other.targetPath.clear();
+}
+
+MappedSuperLong& MappedSuperLong::operator=(MappedSuperLong&& other) noexcept {
+  if (this != &other) {
+    release();
+    filePath = std::move(other.filePath);
+    targetPath = std::move(other.targetPath);
+    fd = other.fd;
+    sign = other.sign;
+    count = other.count;
+    other.fd = -1;
+    other.targetPath.clear();
+  }
+  return *this;
+}
+
+MappedSuperLong::~MappedSuperLong() {
+  release();
+}
+
+// A result that never reached publish() leaves no temporary file behind
+void MappedSuperLong::release() noexcept {
+  if (fd >= 0) {
+    close(fd);
+    fd = -1;
+  }
+  if (!targetPath.empty()) {
+    unlink(filePath.c_str());
+    targetPath.clear();
+  }
+}
+
+MappedSuperLong MappedSuperLong::create(const std::string& path, const SuperLong& value) {
+  MappedSuperLong result = allocate(path, value.digits.size());
+  const n256* limbs = value.digits.data();
+  size_t written = 0;
+  while (written < value.digits.size()) {
+    ssize_t n = pwrite(result.fd, limbs + written, value.digits.size() - written,
+                       static_cast<off_t>(kHeader + written));
+    if (n <= 0) {
+      throw std::runtime_error("Failed to write file: " + path);
+    }
+    written += static_cast<size_t>(n);
+  }
+  result.trim(value.sign);
+  result.publish();
+  return result;
+}
+
+MappedSuperLong MappedSuperLong::open(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Cannot open file for reading: " + path);
+  }
+  MappedSuperLong result {path, fd, Sign::Positive, 0};
+
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    throw std::runtime_error("Cannot open file for reading: " + path);
+  }
+  size_t size = static_cast<size_t>(info.st_size);
+  MappedWindow whole {fd, 0, size, false};
+  size_t consumed = 0;
+  SuperLongView view = SuperLongView::parse(whole.data(), size, &consumed);
+  if (consumed != size) {
+    throw std::invalid_argument("File has trailing data after the value: " + path);
+  }
+  result.sign = view.isNegative() ? Sign::Negative : Sign::Positive;
+  result.count = view.size();
+  return result;
+}
+
+bool MappedSuperLong::isZero() const {
+  if (count != 1) {
+    return false;
+  }
+  return loadLimbs(0, 1).isZero();
+}
+
+bool MappedSuperLong::isNegative() const {
+  return sign == Sign::Negative;
+}
+
+size_t MappedSuperLong::size() const {
+  return count;
+}
+
+const std::string& MappedSuperLong::path() const {
+  return filePath;
+}
+
+SuperLong MappedSuperLong::toSuperLong() const {
+  SuperLong result = loadLimbs(0, count);
+  result.sign = result.isZero() ? Sign::Positive : sign;
+  return result;
+}
+
+MappedSuperLong MappedSuperLong::add(const MappedSuperLong& a, const MappedSuperLong& b, const std::string& path,
+                                     size_t budget) {
+  return addSigned(a, b, b.sign, path, budget);
+}
+
+MappedSuperLong MappedSuperLong::subtract(const MappedSuperLong& a, const MappedSuperLong& b,
+                                          const std::string& path, size_t budget) {
+  return addSigned(a, b, (b.sign == Sign::Negative) ? Sign::Positive : Sign::Negative, path, budget);
+}
+
+// Splits both operands into blocks that the in-memory multiplication tiers
+// handle comfortably and adds every block product into the output file
+MappedSuperLong MappedSuperLong::multiply(const MappedSuperLong& a, const MappedSuperLong& b,
+                                          const std::string& path, size_t budget) {
+  size_t capacity = a.count + b.count;
+  MappedSuperLong result = allocate(path, capacity);
+  size_t block = std::max<size_t>(1, budget / kMultiplyBlocks);
+  size_t chunk = windowLimbs(budget, kMultiplyBlocks / 2);
+
+  for (size_t i = 0; i < a.count; i += block) {
+    SuperLong blockA = a.loadLimbs(i, std::min(block, a.count - i));
+    if (blockA.isZero()) {
+      continue;
+    }
+    for (size_t j = 0; j < b.count; j += block) {
+      SuperLong partial = blockA * b.loadLimbs(j, std::min(block, b.count - j));
+      if (!partial.isZero()) {
+        accumulateLimbs(result.fd, i + j, partial.digits.data(), partial.digits.size(), capacity, chunk);
+      }
+    }
+  }
+
+  result.trim((a.sign != b.sign) ? Sign::Negative : Sign::Positive);
+  result.publish();
+  return result;
+}
+
+MappedSuperLong MappedSuperLong::addSigned(const MappedSuperLong& a, const MappedSuperLong& b, Sign signB,
+                                           const std::string& path, size_t budget) {
+  size_t chunk = windowLimbs(budget, kAddWindows);
+
+  if (a.sign == signB) {
+    size_t n = std::max(a.count, b.count);
+    MappedSuperLong result = allocate(path, n + 1);
+    n256 carry = static_cast<n256>(combineLimbs(a.fd, a.count, b.fd, b.count, result.fd, n, false, chunk));
+    if (pwrite(result.fd, &carry, 1, static_cast<off_t>(kHeader + n)) != 1) {
+      throw std::runtime_error("Failed to write file: " + path);
+    }
+    result.trim(a.sign);
+    result.publish();
+    return result;
+  }
+
+  int cmp = a.compareMagnitude(b, budget);
+  const MappedSuperLong& larger = (cmp >= 0) ? a : b;
+  const MappedSuperLong& smaller = (cmp >= 0) ? b : a;
+  MappedSuperLong result = allocate(path, larger.count);
+  combineLimbs(larger.fd, larger.count, smaller.fd, smaller.count, result.fd, larger.count, true, chunk);
+  result.trim((cmp >= 0) ? a.sign : signB);
+  result.publish();
+  return result;
+}
+
+SuperLong MappedSuperLong::loadLimbs(size_t offset, size_t length) const {
+  MappedWindow window {fd, kHeader + offset, length, false};
+  return SuperLong {Sign::Positive, window.data(), length};
+}
+
+int MappedSuperLong::compareMagnitude(const MappedSuperLong& other, size_t budget) const {
+  if (count != other.count) {
+    return (count < other.count) ? -1 : 1;
+  }
+  size_t chunk = windowLimbs(budget, 2);
+  for (size_t end = count; end > 0;) {
+    size_t length = std::min(chunk, end);
+    end -= length;
+    MappedWindow x {fd, kHeader + end, length, false};
+    MappedWindow y {other.fd, kHeader + end, length, false};
+    for (size_t i = length; i-- > 0;) {
+      if (x.data()[i] != y.data()[i]) {
+        return (x.data()[i] < y.data()[i]) ? -1 : 1;
+      }
+    }
+  }
+  return 0;
+}
+
+// The temporary name is unique to this process and call, and O_EXCL keeps
+// it from ever opening an existing file, an operand included
+MappedSuperLong MappedSuperLong::allocate(const std::string& path, size_t capacity) {
+  static std::atomic<uint64_t> serial {0};
+  std::string temporary = path + ".tmp." + std::to_string(getpid()) + "." + std::to_string(serial++);
+  int fd = ::open(temporary.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+  if (fd < 0) {
+    throw std::runtime_error("Cannot open file for writing: " + path);
+  }
+  MappedSuperLong result {temporary, fd, Sign::Positive, std::max<size_t>(capacity, 1)};
+  result.targetPath = path;
+  if (ftruncate(fd, static_cast<off_t>(kHeader + result.count)) != 0) {
+    throw std::runtime_error("Failed to write file: " + path);
+  }
+  return result;
+}
+
+// Operands open at the old path keep reading the file they opened
+void MappedSuperLong::publish() {
+  if (rename(filePath.c_str(), targetPath.c_str()) != 0) {
+    throw std::runtime_error("Failed to write file: " + targetPath);
+  }
+  filePath = std::move(targetPath);
+  targetPath.clear();
+}
+
+void MappedSuperLong::trim(Sign resultSign) {
+  n256 buffer[kTrimBuffer];
+  size_t top = count;
+  size_t used = 0;
+  while (top > 0 && used == 0) {
+    size_t length = std::min(kTrimBuffer, top);
+    top -= length;
+    if (pread(fd, buffer, length, static_cast<off_t>(kHeader + top)) != static_cast<ssize_t>(length)) {
+      throw std::runtime_error("Failed to read file: " + filePath);
+    }
+    for (size_t i = length; i-- > 0;) {
+      if (buffer[i] != 0) {
+        used = top + i + 1;
+        break;
+      }
+    }
+  }
+
+  sign = (used == 0) ? Sign::Positive : resultSign;
+  count = std::max<size_t>(used, 1);
+  uint8_t header[kHeader];
+  header[0] = (sign == Sign::Negative) ? kHeaderNegative : kHeaderPositive;
+  for (size_t i = 0; i < sizeof(uint64_t); i++) {
+    header[1 + i] = static_cast<uint8_t>(static_cast<uint64_t>(count) >> (8 * i));
+  }
+  if (ftruncate(fd, static_cast<off_t>(kHeader + count)) != 0 ||
+      pwrite(fd, header, kHeader, 0) != static_cast<ssize_t>(kHeader)) {
+    throw std::runtime_error("Failed to write file: " + filePath);
+  }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "superlong.hpp"
+
+namespace aoi {
+
+  // A SuperLong whose limbs live in a file in the serialize() wire format,
+  // so the file can also be read back with SuperLongView. Arithmetic streams
+  // the operands through memory-mapped windows and keeps roughly `budget`
+  // bytes resident at a time, so operands and results may exceed RAM. POSIX only
+  class MappedSuperLong {
+   public:
+    static constexpr size_t kDefaultResidentBudget = size_t {64} << 20;
+
+    static MappedSuperLong create(const std::string& path, const SuperLong& value);
+    static MappedSuperLong open(const std::string& path);
+
+    MappedSuperLong(MappedSuperLong&& other) noexcept;
+    MappedSuperLong& operator=(MappedSuperLong&& other) noexcept;
+    ~MappedSuperLong();
+
+    MappedSuperLong(const MappedSuperLong&) = delete;
+    MappedSuperLong& operator=(const MappedSuperLong&) = delete;
+
+    bool isZero() const;
+    bool isNegative() const;
+    size_t size() const;
+    const std::string& path() const;
+
+    SuperLong toSuperLong() const;
+
+    // Each operation writes its result to a temporary file beside `path` and
+    // renames it into place when done, so `path` may name one of the operands
+    static MappedSuperLong add(const MappedSuperLong& a, const MappedSuperLong& b, const std::string& path,
+                               size_t budget = kDefaultResidentBudget);
+    static MappedSuperLong subtract(const MappedSuperLong& a, const MappedSuperLong& b, const std::string& path,
+                                    size_t budget = kDefaultResidentBudget);
+    static MappedSuperLong multiply(const MappedSuperLong& a, const MappedSuperLong& b, const std::string& path,
+                                    size_t budget = kDefaultResidentBudget);
+
+   private:
+    MappedSuperLong(std::string path, int fd, Sign sign, size_t count);
+
+    std::string filePath;
+    // Where publish() moves filePath to; empty once the file is in place
+    std::string targetPath;
+    int fd;
+    Sign sign;
+    size_t count;
+
+    SuperLong loadLimbs(size_t offset, size_t length) const;
+    int compareMagnitude(const MappedSuperLong& other, size_t budget) const;
+
+    static MappedSuperLong addSigned(const MappedSuperLong& a, const MappedSuperLong& b, Sign signB,
+                                     const std::string& path, size_t budget);
+
+    // Creates a zero-filled temporary file with room for `capacity` limbs;
+    // trim() then drops the leading zero limbs and writes the header, and
+    // publish() renames the file to `path`
+    static MappedSuperLong allocate(const std::string& path, size_t capacity);
+    void trim(Sign resultSign);
+    void publish();
+    void release() noexcept;
+  };
+
+}
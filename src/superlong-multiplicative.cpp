@@ -2,6 +2,8 @@
 #include <stdexcept>
 
 #include "superlong.hpp"
+#include "superlong-async.hpp"
+#include "superlong-trace.hpp"
 
 using namespace aoi;
 
@@ -9,6 +11,31 @@ static constexpr size_t kByteBits = 8;
 static constexpr size_t kByteBase = 1 << kByteBits;
 
 static constexpr size_t KARATSUBA_THRESHOLD = 32;
+// From this size ratio on, the longer operand is multiplied block by block
+static constexpr size_t kChopRatio = 2;
+// Between 3/2 and kChopRatio, Toom-3/2 replaces Karatsuba
+static constexpr size_t kToom32Num = 3;
+static constexpr size_t kToom32Den = 2;
+
+static constexpr size_t kQuotientEstimateBytes = 4;
+
+// Once both the divisor and the quotient reach this many limbs, division
+// goes through a Newton reciprocal and costs a few multiplications
+static constexpr size_t kNewtonDivisionLimbs = 64;
+// Extra limbs carried past the half-size reciprocal, and kept below a
+// truncated short quotient, so either estimate is off by a unit or two
+static constexpr size_t kGuardLimbs = 3;
+
+// Quotient bytes between cancellation checkpoints in long division
+static constexpr size_t kProgressInterval = 16;
+
+static uint64_t leadingBytes(const LimbBuffer& digits, size_t from) {
+  uint64_t value = 0;
+  for (size_t i = digits.size(); i-- > from;) {
+    value = (value << kByteBits) | digits[i];
+  }
+  return value;
+}
 
 SuperLong& SuperLong::operator*=(const SuperLong& other) {
   *this = *this * other;
@@ -26,14 +53,17 @@ SuperLong& SuperLong::operator%=(const SuperLong& other) {
 }
 
 SuperLong SuperLong::operator*(const SuperLong& other) const {
+  detail::TraceScope trace {TraceOp::Multiply, *this, &other};
   return multiply(*this, other);
 }
 
 SuperLong SuperLong::operator/(const SuperLong& other) const {
+  detail::TraceScope trace {TraceOp::Divide, *this, &other};
   return divide_quo_rem(*this, other).first;
 }
 
 SuperLong SuperLong::operator%(const SuperLong& other) const {
+  detail::TraceScope trace {TraceOp::Modulo, *this, &other};
   return divide_quo_rem(*this, other).second;
 }
 
@@ -54,21 +84,42 @@ SuperLong SuperLong::operator>>(size_t shift) const {
   size_t byteShift = shift / kByteBits;
   size_t bitShift = shift % kByteBits;
 
-  SuperLong result {*this};
-  result = result.divid256n(byteShift);
-  return result / (1 << (bitShift));
+  SuperLong result = divid256n(byteShift);
+  if (bitShift == 0 || result.isZero()) {
+    return result;
+  }
+  n256* limbs = result.digits.data();
+  size_t size = result.digits.size();
+  for (size_t i = 0; i < size; i++) {
+    n256plus high = (i + 1 < size) ? limbs[i + 1] : 0;
+    limbs[i] = static_cast<n256>((limbs[i] >> bitShift) | (high << (kByteBits - bitShift)));
+  }
+  result.removeLeadingZeros();
+  return result;
 }
 
 SuperLong SuperLong::operator<<(size_t shift) const {
-  if (shift == 0) {
+  if (shift == 0 || isZero()) {
     return *this;
   }
   size_t byteShift = shift / kByteBits;
   size_t bitShift = shift % kByteBits;
 
-  SuperLong result {*this};
-  result = result.multi256n(byteShift);
-  return result * (1 << (bitShift));
+  SuperLong result = multi256n(byteShift);
+  if (bitShift == 0) {
+    return result;
+  }
+  n256plus carry = 0;
+  n256* limbs = result.digits.data();
+  for (size_t i = byteShift; i < result.digits.size(); i++) {
+    n256plus shifted = (static_cast<n256plus>(limbs[i]) << bitShift) | carry;
+    limbs[i] = static_cast<n256>(shifted & (kByteBase - 1));
+    carry = shifted >> kByteBits;
+  }
+  if (carry > 0) {
+    result.digits.push_back(static_cast<n256>(carry));
+  }
+  return result;
 }
 
 SuperLong SuperLong::multiply(const SuperLong& a, const SuperLong& b) {
@@ -84,51 +135,132 @@ SuperLong SuperLong::multiply_karatsuba(const SuperLong& x, const SuperLong& y)
   if (x.digits.size() < KARATSUBA_THRESHOLD || y.digits.size() < KARATSUBA_THRESHOLD) {
     return multiply_simple(x, y);
   }
+  detail::checkpoint();
+  const SuperLong& longer = (x.digits.size() >= y.digits.size()) ? x : y;
+  const SuperLong& shorter = (&longer == &x) ? y : x;
+  if (longer.digits.size() >= kChopRatio * shorter.digits.size()) {
+    return multiply_unbalanced(longer, shorter);
+  }
+  if (kToom32Den * longer.digits.size() >= kToom32Num * shorter.digits.size()) {
+    return multiply_toom32(longer, shorter);
+  }
+
+  detail::OperationScope scope;
   size_t m = std::min(x.digits.size(), y.digits.size()) / 2;
 
-  SuperLong b = x.divid256n(m);
-  SuperLong a = x.multi256n(b.digits.size());
-  SuperLong d = y.divid256n(m);
-  SuperLong c = y.multi256n(d.digits.size());
+  SuperLong a = x.divid256n(m);
+  SuperLong b = x.mod256n(m);
+  SuperLong c = y.divid256n(m);
+  SuperLong d = y.mod256n(m);
 
   SuperLong z0 = multiply_karatsuba(b, d);
+  scope.progress(1.0 / 3);
   SuperLong z1 = multiply_karatsuba(a + b, c + d);
+  scope.progress(2.0 / 3);
   SuperLong z2 = multiply_karatsuba(a, c);
+  scope.progress(1.0);
 
   return z2.multi256n(2 * m) + (z1 - z2 - z0).multi256n(m) + z0;
 }
 
-SuperLong SuperLong::multiply_simple(const SuperLong& a, const SuperLong& b) {
+// Chops the longer operand into blocks the size of the shorter one, so
+// every partial product is balanced, and adds each in at its offset
+SuperLong SuperLong::multiply_unbalanced(const SuperLong& longer, const SuperLong& shorter) {
+  detail::OperationScope scope;
+  SuperLong factor = shorter;
+  factor.sign = Sign::Positive;
+  size_t block = factor.digits.size();
+  size_t total = longer.digits.size();
+  const n256* limbs = longer.digits.data();
+
   SuperLong result;
-  result.digits.clear();
+  result.digits.assign(total + block, 0);
+  n256* out = result.digits.data();
+  for (size_t offset = 0; offset < total; offset += block) {
+    size_t count = std::min(block, total - offset);
+    SuperLong product = multiply_karatsuba(SuperLong {Sign::Positive, limbs + offset, count}, factor);
+    const n256* p = product.digits.data();
+    n256plus carry = 0;
+    size_t i = 0;
+    for (; i < product.digits.size(); i++) {
+      n256plus sum = out[offset + i] + p[i] + carry;
+      out[offset + i] = static_cast<n256>(sum & (kByteBase - 1));
+      carry = sum >> kByteBits;
+    }
+    for (; carry != 0 && offset + i < total + block; i++) {
+      n256plus sum = out[offset + i] + carry;
+      out[offset + i] = static_cast<n256>(sum & (kByteBase - 1));
+      carry = sum >> kByteBits;
+    }
+    scope.progress(static_cast<double>(offset + count) / total);
+  }
+  result.removeLeadingZeros();
+  return result;
+}
 
-  result.digits.reserve(a.digits.size() + b.digits.size());
+// Toom-3/2: the longer operand is split into three parts and the shorter
+// into two, and the degree-3 product is interpolated from its values at
+// 0, 1, -1 and infinity, which takes four multiplications instead of six
+SuperLong SuperLong::multiply_toom32(const SuperLong& longer, const SuperLong& shorter) {
+  detail::OperationScope scope;
+  SuperLong x = longer;
+  SuperLong y = shorter;
+  x.sign = y.sign = Sign::Positive;
+  size_t n = (x.digits.size() + 2) / 3;
+
+  SuperLong x0 = x.mod256n(n);
+  SuperLong x1 = x.divid256n(n).mod256n(n);
+  SuperLong x2 = x.divid256n(2 * n);
+  SuperLong y0 = y.mod256n(n);
+  SuperLong y1 = y.divid256n(n);
+
+  SuperLong xEven = x0 + x2;
+  SuperLong xPlus = xEven + x1;
+  SuperLong xMinus = xEven - x1;
+  SuperLong yPlus = y0 + y1;
+  SuperLong yMinus = y0 - y1;
+  bool negativeAtMinusOne = xMinus.isNegative() != yMinus.isNegative();
+  xMinus.sign = yMinus.sign = Sign::Positive;
+
+  SuperLong w0 = multiply_karatsuba(x0, y0);
+  scope.progress(0.25);
+  SuperLong w1 = multiply_karatsuba(xPlus, yPlus);
+  scope.progress(0.5);
+  SuperLong wMinus = multiply_karatsuba(xMinus, yMinus);
+  if (negativeAtMinusOne && !wMinus.isZero()) {
+    wMinus.sign = Sign::Negative;
+  }
+  scope.progress(0.75);
+  SuperLong wInf = multiply_karatsuba(x2, y1);
+  scope.progress(1.0);
+
+  // w(1) + w(-1) = 2 (r0 + r2) and w(1) - w(-1) = 2 (r1 + r3)
+  SuperLong r2 = ((w1 + wMinus) >> 1) - w0;
+  SuperLong r1 = ((w1 - wMinus) >> 1) - wInf;
+  return wInf.multi256n(3 * n) + r2.multi256n(2 * n) + r1.multi256n(n) + w0;
+}
 
-  for (size_t i = 0; i < a.digits.size(); i++) {
-    SuperLong temp;
-    temp.digits.clear();
+SuperLong SuperLong::multiply_simple(const SuperLong& a, const SuperLong& b) {
+  SuperLong result;
+  result.digits.assign(a.digits.size() + b.digits.size(), 0);
+  n256* out = result.digits.data();
+  const n256* limbsB = b.digits.data();
+  size_t sizeB = b.digits.size();
 
-    for (size_t k = 0; k < i; k++) {
-      temp.digits.push_back(0);
+  for (size_t i = 0; i < a.digits.size(); i++) {
+    n256plus digitA = a.digits[i];
+    if (digitA == 0) {
+      continue;
     }
     n256plus carry = 0;
 
-    for (size_t j = 0; j < b.digits.size(); j++) {
-      n256 digitA = a.digits[i];
-      n256 digitB = (j < b.digits.size()) ? b.digits[j] : 0;
-
-      n256plus product = static_cast<n256plus>(digitA) * static_cast<n256plus>(digitB) + carry;
+    for (size_t j = 0; j < sizeB; j++) {
+      n256plus product = digitA * limbsB[j] + out[i + j] + carry;
 
-      temp.digits.push_back(static_cast<n256>(product & (kByteBase - 1)));
-      carry = static_cast<n256plus>(product >> kByteBits);
+      out[i + j] = static_cast<n256>(product & (kByteBase - 1));
+      carry = product >> kByteBits;
     }
-    while (carry > 0) {
-      temp.digits.push_back(static_cast<n256>(carry & (kByteBase - 1)));
-      carry >>= kByteBits;
-    }
-    temp.sign = Sign::Positive;
-
-    result = add(result, temp);
+    out[i + sizeB] = static_cast<n256>(carry);
   }
   result.removeLeadingZeros();
 
@@ -150,16 +282,39 @@ std::pair<SuperLong, SuperLong> SuperLong::divide_quo_rem(const SuperLong& a, co
     return {SuperLong {}, a};
   }
 
+  if (divisor.digits.size() >= kNewtonDivisionLimbs &&
+      dividend.digits.size() - divisor.digits.size() >= kNewtonDivisionLimbs) {
+    auto [quotient, remainder] = divide_newton(dividend, divisor);
+    if (!remainder.isZero()) {
+      remainder.sign = a.sign;
+    }
+    if (!quotient.isZero() && a.sign != b.sign) {
+      quotient.sign = Sign::Negative;
+    }
+    return {quotient, remainder};
+  }
+
   SuperLong quotient, remainder;
   quotient.digits.clear();
 
+  // The leading bytes of the divisor bound each quotient digit to a range
+  // that is almost always one or two values wide
+  size_t topShift = divisor.digits.size() - std::min(divisor.digits.size(), kQuotientEstimateBytes);
+  uint64_t divisorTop = leadingBytes(divisor.digits, topShift);
+
+  detail::OperationScope scope;
   for (size_t i = dividend.digits.size(); i-- > 0;) {
+    if (i % kProgressInterval == 0) {
+      detail::checkpoint();
+      scope.progress(1.0 - static_cast<double>(i) / dividend.digits.size());
+    }
     remainder = remainder.multi256n(1) + SuperLong(dividend.digits[i]);
 
     if (abscmp(remainder, divisor) >= 0) {
+      uint64_t remainderTop = leadingBytes(remainder.digits, topShift);
       int best = 0;
-      int low = 1;
-      int high = 255;
+      int low = static_cast<int>(std::max<uint64_t>(1, remainderTop / (divisorTop + 1)));
+      int high = static_cast<int>(std::min<uint64_t>(kByteBase - 1, (remainderTop + 1) / divisorTop));
 
       while (low <= high) {
         int mid = low + (high - low) / 2;
@@ -184,11 +339,179 @@ std::pair<SuperLong, SuperLong> SuperLong::divide_quo_rem(const SuperLong& a, co
   quotient.removeLeadingZeros();
   remainder.removeLeadingZeros();
 
-  remainder.sign = a.sign;
+  if (!remainder.isZero()) {
+    remainder.sign = a.sign;
+  }
   quotient.sign = (a.sign == b.sign) ? Sign::Positive : Sign::Negative;
   return {quotient, remainder};
 }
 
+// About 256^(2k) / d, within a few units, for a d of k limbs. The
+// reciprocal y of the top half of d, scaled up, is already right to about
+// half the limbs, and one Newton step x + x (256^(2k) - d x) / 256^(2k)
+// doubles that. Only the top limbs of x are nonzero, so d x is an
+// unbalanced product and the correction is short
+SuperLong SuperLong::reciprocal(const SuperLong& d) {
+  size_t k = d.digits.size();
+  SuperLong scale = SuperLong {1}.multi256n(2 * k);
+  if (k < kNewtonDivisionLimbs) {
+    return divide_quo_rem(scale, d).first;
+  }
+
+  size_t half = k / 2 + kGuardLimbs;
+  size_t low = k - half;
+  SuperLong y = reciprocal(d.divid256n(low));
+  SuperLong error = scale - (d * y).multi256n(low);
+  return y.multi256n(low) + (y * error).divid256n(2 * k - low);
+}
+
+// Barrett reduction of a < 256^(2k) by a d of k limbs with v = reciprocal(d):
+// the estimate from the top limbs of a is within a few units of the quotient
+std::pair<SuperLong, SuperLong> SuperLong::divide_barrett(const SuperLong& a, const SuperLong& d, const SuperLong& v) {
+  size_t k = d.digits.size();
+  SuperLong quotient = (a.divid256n(k - 1) * v).divid256n(k + 1);
+  SuperLong remainder = a - quotient * d;
+  while (remainder.isNegative()) {
+    quotient -= SuperLong {1};
+    remainder += d;
+  }
+  while (remainder >= d) {
+    quotient += SuperLong {1};
+    remainder -= d;
+  }
+  return {quotient, remainder};
+}
+
+// Division of positive a >= d by multiplication only. A quotient much
+// shorter than d depends on the top limbs alone; one up to the length of d
+// is a single Barrett step; a longer one comes k limbs at a time from the
+// top, as in long division with 256^k as the digit base
+std::pair<SuperLong, SuperLong> SuperLong::divide_newton(const SuperLong& a, const SuperLong& d) {
+  size_t k = d.digits.size();
+  size_t total = a.digits.size();
+  size_t quotientLimbs = total - k + 1;
+
+  if (quotientLimbs + kGuardLimbs < k) {
+    size_t drop = k - quotientLimbs - kGuardLimbs;
+    SuperLong quotient = divide_newton(a.divid256n(drop), d.divid256n(drop)).first;
+    SuperLong remainder = a - quotient * d;
+    while (remainder.isNegative()) {
+      quotient -= SuperLong {1};
+      remainder += d;
+    }
+    while (remainder >= d) {
+      quotient += SuperLong {1};
+      remainder -= d;
+    }
+    return {quotient, remainder};
+  }
+
+  SuperLong v = reciprocal(d);
+  if (total <= 2 * k) {
+    return divide_barrett(a, d, v);
+  }
+
+  detail::OperationScope scope;
+  SuperLong quotient;
+  quotient.digits.assign(total, 0);
+  const n256* limbs = a.digits.data();
+  size_t pos = (total - 1) / k * k;
+  SuperLong remainder {Sign::Positive, limbs + pos, total - pos};
+  std::vector<n256> window;
+  while (true) {
+    auto [digit, rest] = divide_barrett(remainder, d, v);
+    std::copy(digit.digits.begin(), digit.digits.end(), quotient.digits.data() + pos);
+    if (pos == 0) {
+      remainder = std::move(rest);
+      break;
+    }
+    detail::checkpoint();
+    scope.progress(1.0 - static_cast<double>(pos) / total);
+    pos -= k;
+    window.assign(limbs + pos, limbs + pos + k);
+    window.insert(window.end(), rest.digits.begin(), rest.digits.end());
+    remainder = SuperLong {Sign::Positive, window.data(), window.size()};
+  }
+  quotient.removeLeadingZeros();
+  return {quotient, remainder};
+}
+
+// Jebelean's exact division. Once b is odd, the low byte of the running
+// dividend times b^-1 mod 256 is the next quotient byte, so the quotient
+// comes out from the low end with no remainder and no normalization. Only
+// the bytes below the quotient length are ever updated. The loop is
+// quadratic, so once divisor and quotient both reach kNewtonDivisionLimbs
+// the Newton division takes over
+SuperLong aoi::divexact(const SuperLong& a, const SuperLong& b) {
+  detail::UntracedScope untraced;
+  if (b.isZero()) {
+    throw std::invalid_argument("Division by zero");
+  }
+  if (a.isZero()) {
+    return SuperLong {};
+  }
+
+  // b divides a, so a shares every trailing zero bit of b
+  size_t shift = 0;
+  while (b.digits[shift / kByteBits] == 0) {
+    shift += kByteBits;
+  }
+  while (((b.digits[shift / kByteBits] >> (shift % kByteBits)) & 1) == 0) {
+    shift++;
+  }
+  SuperLong dividend = a >> shift;
+  SuperLong divisor = b >> shift;
+
+  SuperLong quotient;
+  size_t divisorSize = divisor.digits.size();
+  size_t quotientSize = (dividend.digits.size() >= divisorSize) ? dividend.digits.size() - divisorSize + 1 : 0;
+  if (divisorSize >= kNewtonDivisionLimbs && quotientSize >= kNewtonDivisionLimbs) {
+    quotient = SuperLong::divide_quo_rem(dividend, divisor).first;
+    quotient.sign = Sign::Positive;
+  } else if (quotientSize > 0) {
+    std::vector<n256> rest(dividend.digits.begin(), dividend.digits.begin() + quotientSize);
+    const n256* d = divisor.digits.data();
+
+    // Newton iteration: an odd byte is its own inverse modulo 8, and each
+    // step doubles the number of correct low bits
+    n256 inverse = d[0];
+    for (int i = 0; i < 2; i++) {
+      inverse = static_cast<n256>(inverse * (2 - d[0] * inverse));
+    }
+
+    quotient.digits.resize(quotientSize);
+    n256* q = quotient.digits.data();
+    for (size_t i = 0; i < quotientSize; i++) {
+      n256 digit = static_cast<n256>(rest[i] * inverse);
+      q[i] = digit;
+      n256plus borrow = 0;
+      size_t j = 0;
+      for (; j < std::min(divisorSize, quotientSize - i); j++) {
+        n256plus product = digit * d[j] + borrow;
+        n256 low = static_cast<n256>(product & (kByteBase - 1));
+        borrow = (product >> kByteBits) + (rest[i + j] < low ? 1 : 0);
+        rest[i + j] = static_cast<n256>(rest[i + j] - low);
+      }
+      for (; borrow != 0 && i + j < quotientSize; j++) {
+        n256plus low = borrow & (kByteBase - 1);
+        borrow = (borrow >> kByteBits) + (rest[i + j] < low ? 1 : 0);
+        rest[i + j] = static_cast<n256>(rest[i + j] - low);
+      }
+    }
+    quotient.removeLeadingZeros();
+  }
+  if (!quotient.isZero() && a.sign != b.sign) {
+    quotient.sign = Sign::Negative;
+  }
+
+#ifdef DEBUG
+  if (quotient * b != a) {
+    throw std::logic_error("divexact: division is not exact");
+  }
+#endif
+  return quotient;
+}
+
 SuperLong SuperLong::multi256n(size_t shift) const {
   if (shift == 0 || isZero()) {
     return *this;
@@ -215,3 +538,42 @@ SuperLong SuperLong::divid256n(size_t shift) const {
 
   return result;
 }
+
+uint32_t SuperLong::divmodSmall(uint32_t divisor) {
+  uint64_t remainder = 0;
+  n256* limbs = digits.data();
+  for (size_t i = digits.size(); i-- > 0;) {
+    uint64_t value = (remainder << kByteBits) | limbs[i];
+    limbs[i] = static_cast<n256>(value / divisor);
+    remainder = value % divisor;
+  }
+  removeLeadingZeros();
+  return static_cast<uint32_t>(remainder);
+}
+
+void SuperLong::mulAddSmall(uint32_t factor, uint32_t addend) {
+  uint64_t carry = addend;
+  n256* limbs = digits.data();
+  for (size_t i = 0; i < digits.size(); i++) {
+    uint64_t value = static_cast<uint64_t>(limbs[i]) * factor + carry;
+    limbs[i] = static_cast<n256>(value & (kByteBase - 1));
+    carry = value >> kByteBits;
+  }
+  while (carry > 0) {
+    digits.push_back(static_cast<n256>(carry & (kByteBase - 1)));
+    carry >>= kByteBits;
+  }
+  removeLeadingZeros();
+}
+
+SuperLong SuperLong::mod256n(size_t shift) const {
+  if (shift >= digits.size()) {
+    return *this;
+  }
+  SuperLong result;
+  result.sign = sign;
+  result.digits.assign(digits.begin(), digits.begin() + shift);
+  result.removeLeadingZeros();
+
+  return result;
+}
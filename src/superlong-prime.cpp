@@ -0,0 +1,302 @@
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "montgomery.hpp"
+#include "superlong.hpp"
+#include "superlong-trace.hpp"
+
+using namespace aoi;
+
+static constexpr uint32_t kTrialDivisionLimit = 1024;
+static constexpr int64_t kTrialDivisionSquare = int64_t {kTrialDivisionLimit} * kTrialDivisionLimit;
+// Odd candidates covered by one sieve pass in next_prime
+static constexpr size_t kSieveWindow = 4096;
+// A perfect square has no Selfridge parameter, so after this many failed
+// candidates the search checks for one instead of running forever
+static constexpr int kSquareCheckAttempts = 8;
+
+// Small odd primes packed into groups whose product fits in a word, so one
+// word-sized remainder per group yields the residues of all its primes
+struct PrimeGroup {
+  uint32_t product;
+  size_t first;
+  size_t last;
+};
+
+struct SmallPrimes {
+  std::vector<uint32_t> primes;
+  std::vector<PrimeGroup> groups;
+  SuperLong product;
+};
+
+static SmallPrimes buildSmallPrimes() {
+  SmallPrimes table;
+  std::vector<bool> composite(kTrialDivisionLimit, false);
+  for (uint32_t i = 3; i < kTrialDivisionLimit; i += 2) {
+    if (composite[i]) {
+      continue;
+    }
+    table.primes.push_back(i);
+    for (uint32_t j = i * i; j < kTrialDivisionLimit; j += 2 * i) {
+      composite[j] = true;
+    }
+  }
+
+  std::vector<SuperLong> groupProducts;
+  for (size_t i = 0; i < table.primes.size();) {
+    PrimeGroup group {1, i, i};
+    while (group.last < table.primes.size() &&
+           uint64_t {group.product} * table.primes[group.last] <= UINT32_MAX) {
+      group.product *= table.primes[group.last++];
+    }
+    table.groups.push_back(group);
+    groupProducts.push_back(SuperLong {int64_t {group.product}});
+    i = group.last;
+  }
+  table.product = product(groupProducts);
+  return table;
+}
+
+static const SmallPrimes& smallPrimes() {
+  static const SmallPrimes table = buildSmallPrimes();
+  return table;
+}
+
+static uint32_t limbsMod(const LimbBuffer& limbs, uint32_t modulus) {
+  uint64_t r = 0;
+  for (size_t i = limbs.size(); i-- > 0;) {
+    r = ((r << 8) | limbs[i]) % modulus;
+  }
+  return static_cast<uint32_t>(r);
+}
+
+// `limbs` must hold a value already reduced modulo the table product
+static std::vector<uint32_t> smallPrimeResidues(const SmallPrimes& table, const LimbBuffer& limbs) {
+  std::vector<uint32_t> residues(table.primes.size());
+  for (const PrimeGroup& group : table.groups) {
+    uint32_t r = limbsMod(limbs, group.product);
+    for (size_t i = group.first; i < group.last; i++) {
+      residues[i] = r % table.primes[i];
+    }
+  }
+  return residues;
+}
+
+static int jacobiU64(uint64_t a, uint64_t m) {
+  int result = 1;
+  a %= m;
+  while (a != 0) {
+    while (a % 2 == 0) {
+      a /= 2;
+      if (m % 8 == 3 || m % 8 == 5) {
+        result = -result;
+      }
+    }
+    std::swap(a, m);
+    if (a % 4 == 3 && m % 4 == 3) {
+      result = -result;
+    }
+    a %= m;
+  }
+  return (m == 1) ? result : 0;
+}
+
+// (D / n) for a small odd |D| and an odd n > |D|, by reciprocity
+static int jacobiSmall(int64_t d, const LimbBuffer& limbs) {
+  uint64_t magnitude = static_cast<uint64_t>(std::llabs(d));
+  uint64_t nMod4 = limbs[0] & 3;
+  int result = jacobiU64(limbsMod(limbs, static_cast<uint32_t>(magnitude)), magnitude);
+  if (magnitude % 4 == 3 && nMod4 == 3) {
+    result = -result;
+  }
+  if (d < 0 && nMod4 == 3) {
+    result = -result;
+  }
+  return result;
+}
+
+// Splits value = odd * 2^s and returns the odd part's binary digits
+static std::string oddPartBits(const SuperLong& value, size_t& s) {
+  std::string bits = value.toString(2);
+  size_t lastOne = bits.find_last_of('1');
+  s = bits.size() - 1 - lastOne;
+  bits.resize(lastOne + 1);
+  return bits;
+}
+
+static bool millerRabin(const Montgomery& ctx, const SuperLong& d, size_t s, uint32_t base) {
+  Montgomery::Residue one = ctx.one();
+  Montgomery::Residue minusOne = ctx.zero();
+  ctx.subtract(minusOne, one, minusOne);
+
+  Montgomery::Residue x = ctx.pow(ctx.toMontgomery(SuperLong {int64_t {base}}), d);
+  if (x == one || x == minusOne) {
+    return true;
+  }
+  for (size_t r = 1; r < s; r++) {
+    ctx.multiply(x, x, x);
+    if (x == minusOne) {
+      return true;
+    }
+    if (x == one) {
+      return false;
+    }
+  }
+  return false;
+}
+
+// V_2k = V_k^2 - 2 Q^k and Q^2k = (Q^k)^2
+static void lucasDoubleV(const Montgomery& ctx, Montgomery::Residue& v, Montgomery::Residue& qk,
+                         Montgomery::Residue& scratch) {
+  ctx.multiply(v, v, v);
+  ctx.add(qk, qk, scratch);
+  ctx.subtract(v, scratch, v);
+  ctx.multiply(qk, qk, qk);
+}
+
+// Strong Lucas test with Selfridge's parameters: the first D in 5, -7, 9,
+// -11, ... with (D / n) = -1, P = 1 and Q = (1 - D) / 4
+static bool strongLucas(const Montgomery& ctx, const LimbBuffer& limbs) {
+  const SuperLong& n = ctx.modulus();
+  int64_t d = 5;
+  for (int attempt = 0;; attempt++) {
+    int j = jacobiSmall(d, limbs);
+    if (j == -1) {
+      break;
+    }
+    if (j == 0 && n != SuperLong {std::llabs(d)}) {
+      return false;
+    }
+    if (attempt == kSquareCheckAttempts && is_perfect_square(n)) {
+      return false;
+    }
+    d = (d > 0) ? -(d + 2) : -d + 2;
+  }
+
+  size_t s = 0;
+  std::string bits = oddPartBits(n + SuperLong {1}, s);
+
+  Montgomery::Residue dm = ctx.toMontgomery(SuperLong {d});
+  Montgomery::Residue q = ctx.toMontgomery(SuperLong {(1 - d) / 4});
+  Montgomery::Residue u = ctx.one();
+  Montgomery::Residue v = ctx.one();
+  Montgomery::Residue qk = q;
+  Montgomery::Residue nextU;
+  Montgomery::Residue scratch;
+  for (size_t i = 1; i < bits.size(); i++) {
+    ctx.multiply(u, v, u);
+    lucasDoubleV(ctx, v, qk, scratch);
+    if (bits[i] == '1') {
+      // U_k+1 = (P U_k + V_k) / 2 and V_k+1 = (D U_k + P V_k) / 2
+      ctx.add(u, v, nextU);
+      ctx.half(nextU, nextU);
+      ctx.multiply(dm, u, scratch);
+      ctx.add(scratch, v, scratch);
+      ctx.half(scratch, v);
+      u.swap(nextU);
+      ctx.multiply(qk, q, qk);
+    }
+  }
+
+  if (Montgomery::isZero(u) || Montgomery::isZero(v)) {
+    return true;
+  }
+  for (size_t r = 1; r < s; r++) {
+    lucasDoubleV(ctx, v, qk, scratch);
+    if (Montgomery::isZero(v)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Baillie-PSW on an odd n with no factor below the trial division limit,
+// followed by `rounds` Miller-Rabin rounds to the bases 3, 5, 7, ...
+static bool bpsw(const SuperLong& n, const LimbBuffer& limbs, int rounds) {
+  Montgomery ctx(n);
+  size_t s = 0;
+  SuperLong d = SuperLong::fromString(oddPartBits(n - SuperLong {1}, s), 2);
+  if (!millerRabin(ctx, d, s, 2) || !strongLucas(ctx, limbs)) {
+    return false;
+  }
+  const std::vector<uint32_t>& bases = smallPrimes().primes;
+  for (size_t i = 0; i < std::min(static_cast<size_t>(rounds), bases.size()); i++) {
+    if (!millerRabin(ctx, d, s, bases[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool aoi::is_probable_prime(const SuperLong& n, int rounds) {
+  detail::UntracedScope untraced;
+  if (rounds < 0) {
+    throw std::invalid_argument("Round count must be non-negative");
+  }
+  if (n < SuperLong {2}) {
+    return false;
+  }
+  if ((n.digits[0] & 1) == 0) {
+    return n == SuperLong {2};
+  }
+
+  const SmallPrimes& table = smallPrimes();
+  SuperLong reduced = (n < table.product) ? n : n % table.product;
+  std::vector<uint32_t> residues = smallPrimeResidues(table, reduced.digits);
+  for (size_t i = 0; i < residues.size(); i++) {
+    if (residues[i] == 0) {
+      return n == SuperLong {int64_t {table.primes[i]}};
+    }
+  }
+  if (n < SuperLong {kTrialDivisionSquare}) {
+    return true;
+  }
+  return bpsw(n, n.digits, rounds);
+}
+
+SuperLong aoi::next_prime(const SuperLong& n) {
+  detail::UntracedScope untraced;
+  if (n < SuperLong {2}) {
+    return SuperLong {2};
+  }
+  SuperLong candidate = n + SuperLong {1};
+  if ((candidate.digits[0] & 1) == 0) {
+    candidate += SuperLong {1};
+  }
+  while (candidate < SuperLong {kTrialDivisionSquare}) {
+    if (is_probable_prime(candidate)) {
+      return candidate;
+    }
+    candidate += SuperLong {2};
+  }
+
+  // Sieve a window of odd candidates: with r = candidate mod p, the
+  // multiples of p sit at offsets i where r + 2i = 0 (mod p)
+  const SmallPrimes& table = smallPrimes();
+  std::vector<uint8_t> composite(kSieveWindow);
+  for (;;) {
+    SuperLong reduced = (candidate < table.product) ? candidate : candidate % table.product;
+    std::vector<uint32_t> residues = smallPrimeResidues(table, reduced.digits);
+    std::fill(composite.begin(), composite.end(), 0);
+    for (size_t k = 0; k < residues.size(); k++) {
+      uint64_t p = table.primes[k];
+      uint64_t first = (p - residues[k]) % p * ((p + 1) / 2) % p;
+      for (uint64_t i = first; i < kSieveWindow; i += p) {
+        composite[i] = 1;
+      }
+    }
+    for (size_t i = 0; i < kSieveWindow; i++) {
+      if (composite[i]) {
+        continue;
+      }
+      SuperLong value = candidate + SuperLong {static_cast<int64_t>(2 * i)};
+      if (bpsw(value, value.digits, 0)) {
+        return value;
+      }
+    }
+    candidate += SuperLong {static_cast<int64_t>(2 * kSieveWindow)};
+  }
+}
@@ -0,0 +1,142 @@
+#include <stdexcept>
+#include <vector>
+
+#include "superlong.hpp"
+#include "superlong-trace.hpp"
+
+using namespace aoi;
+
+// Leaves are packed until the next factor would push them past int64_t
+static constexpr uint64_t kLeafLimit = static_cast<uint64_t>(INT64_MAX);
+
+// binomial switches from prime-power factorization to a falling factorial
+// when sieving up to n would be too large
+static constexpr uint64_t kSieveLimit = uint64_t {1} << 26;
+
+static SuperLong productTree(const SuperLong* values, size_t count) {
+  if (count == 0) {
+    return SuperLong {1};
+  }
+  if (count == 1) {
+    return values[0];
+  }
+  if (count == 2) {
+    return values[0] * values[1];
+  }
+  size_t half = count / 2;
+  return productTree(values, half) * productTree(values + half, count - half);
+}
+
+static void packFactor(std::vector<SuperLong>& leaves, uint64_t& acc, uint64_t factor) {
+  if (acc > kLeafLimit / factor) {
+    leaves.push_back(SuperLong {static_cast<int64_t>(acc)});
+    acc = factor;
+  } else {
+    acc *= factor;
+  }
+}
+
+static SuperLong productOfLeaves(std::vector<SuperLong>& leaves, uint64_t acc) {
+  if (acc > 1) {
+    leaves.push_back(SuperLong {static_cast<int64_t>(acc)});
+  }
+  return productTree(leaves.data(), leaves.size());
+}
+
+static SuperLong productOfRange(uint64_t first, uint64_t last) {
+  std::vector<SuperLong> leaves;
+  uint64_t acc = 1;
+  for (uint64_t i = first; i <= last; i++) {
+    packFactor(leaves, acc, i);
+  }
+  return productOfLeaves(leaves, acc);
+}
+
+static std::vector<uint64_t> primesUpTo(uint64_t n) {
+  std::vector<uint64_t> primes;
+  if (n < 2) {
+    return primes;
+  }
+  std::vector<bool> composite(n + 1, false);
+  for (uint64_t i = 2; i <= n; i++) {
+    if (composite[i]) {
+      continue;
+    }
+    primes.push_back(i);
+    if (i > n / i) {
+      continue;
+    }
+    for (uint64_t j = i * i; j <= n; j += i) {
+      composite[j] = true;
+    }
+  }
+  return primes;
+}
+
+static void checkFactorLimit(uint64_t n) {
+  if (n > kLeafLimit) {
+    throw std::invalid_argument("Argument is too large");
+  }
+}
+
+SuperLong aoi::product(const SuperLong* values, size_t count) {
+  detail::UntracedScope untraced;
+  return productTree(values, count);
+}
+
+SuperLong aoi::product(const std::vector<SuperLong>& values) {
+  detail::UntracedScope untraced;
+  return productTree(values.data(), values.size());
+}
+
+SuperLong aoi::factorial(uint64_t n) {
+  detail::UntracedScope untraced;
+  checkFactorLimit(n);
+  return productOfRange(2, n);
+}
+
+// Kummer: p divides C(n, k) exactly sum_i (n/p^i - k/p^i - (n-k)/p^i) times,
+// so the result is a product of prime powers and needs no division at all
+SuperLong aoi::binomial(uint64_t n, uint64_t k) {
+  detail::UntracedScope untraced;
+  checkFactorLimit(n);
+  if (k > n) {
+    return SuperLong {};
+  }
+  if (k > n - k) {
+    k = n - k;
+  }
+  if (k == 0) {
+    return SuperLong {1};
+  }
+  if (n > kSieveLimit) {
+    return divexact(productOfRange(n - k + 1, n), productOfRange(2, k));
+  }
+
+  std::vector<SuperLong> leaves;
+  uint64_t acc = 1;
+  for (uint64_t p : primesUpTo(n)) {
+    uint64_t exponent = 0;
+    for (uint64_t power = p; power <= n; power *= p) {
+      exponent += n / power - k / power - (n - k) / power;
+      if (power > n / p) {
+        break;
+      }
+    }
+    for (uint64_t e = 0; e < exponent; e++) {
+      packFactor(leaves, acc, p);
+    }
+  }
+  return productOfLeaves(leaves, acc);
+}
+
+SuperLong aoi::primorial(uint64_t n) {
+  detail::UntracedScope untraced;
+  checkFactorLimit(n);
+  std::vector<SuperLong> leaves;
+  uint64_t acc = 1;
+  for (uint64_t p : primesUpTo(n)) {
+    packFactor(leaves, acc, p);
+  }
+  return productOfLeaves(leaves, acc);
+}
@@ -0,0 +1,330 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "superlong.hpp"
+#include "superlong-async.hpp"
+#include "superlong-trace.hpp"
+
+using namespace aoi;
+
+static constexpr int kMinRadix = 2;
+static constexpr int kMaxRadix = 36;
+
+// Below these sizes the single-word chunk loops beat the recursive split.
+// Both directions split by multiplication only: parsing scales the high
+// half up, formatting divides by a Barrett step with a cached reciprocal
+static constexpr size_t kRadixSplitLimbs = 128;
+static constexpr size_t kRadixSplitChunks = 32;
+
+static constexpr size_t kDigitSinkBufferSize = 4096;
+
+static const char kRadixDigits[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+static void checkRadix(int base) {
+  if (base < kMinRadix || base > kMaxRadix) {
+    throw std::invalid_argument("Radix must be between 2 and 36");
+  }
+}
+
+static int powerOfTwoBits(int base) {
+  if ((base & (base - 1)) != 0) {
+    return 0;
+  }
+  int bits = 0;
+  while ((1 << bits) < base) {
+    bits++;
+  }
+  return bits;
+}
+
+static int digitValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'z') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'Z') {
+    return c - 'A' + 10;
+  }
+  return kMaxRadix;
+}
+
+// Largest power of the radix that fits in a uint32_t, and its exponent
+static std::pair<uint32_t, size_t> radixChunk(int base) {
+  uint32_t power = static_cast<uint32_t>(base);
+  size_t count = 1;
+  while (power <= UINT32_MAX / static_cast<uint32_t>(base)) {
+    power *= static_cast<uint32_t>(base);
+    count++;
+  }
+  return {power, count};
+}
+
+// Writes one chunk into out, zero-padded to width, and returns its length
+static size_t formatRadixChunk(uint32_t chunk, int base, size_t width, char* out) {
+  char reversed[32];
+  size_t len = 0;
+  do {
+    reversed[len++] = kRadixDigits[chunk % static_cast<uint32_t>(base)];
+    chunk /= static_cast<uint32_t>(base);
+  } while (chunk > 0);
+  while (len < width) {
+    reversed[len++] = '0';
+  }
+  for (size_t i = 0; i < len; i++) {
+    out[i] = reversed[len - 1 - i];
+  }
+  return len;
+}
+
+// Digit count of the value in the radix, to within one, for progress reports
+static double expectedDigits(const SuperLong& magnitude, int base) {
+  return static_cast<double>(magnitude.bitLength()) * std::log(2.0) / std::log(static_cast<double>(base)) + 1;
+}
+
+// Collects the digits radix_emit produces in a fixed-size buffer and hands
+// each full buffer on to a string or a stream, reporting progress against
+// the expected digit count as it goes
+class SuperLong::DigitSink {
+ public:
+  DigitSink(std::string* text, std::ostream* stream, double expected)
+      : text(text), stream(stream), expected(expected) {
+  }
+
+  void append(const char* data, size_t count) {
+    if (used + count > kDigitSinkBufferSize) {
+      flush();
+    }
+    std::memcpy(buffer + used, data, count);
+    used += count;
+  }
+
+  void fill(size_t count) {
+    while (count > 0) {
+      if (used == kDigitSinkBufferSize) {
+        flush();
+      }
+      size_t take = std::min(count, kDigitSinkBufferSize - used);
+      std::memset(buffer + used, '0', take);
+      used += take;
+      count -= take;
+    }
+  }
+
+  void finish() {
+    flush();
+    scope.progress(1.0);
+  }
+
+ private:
+  std::string* text;
+  std::ostream* stream;
+  double expected;
+  double written = 0;
+  detail::OperationScope scope;
+  char buffer[kDigitSinkBufferSize];
+  size_t used = 0;
+
+  void flush() {
+    if (text != nullptr) {
+      text->append(buffer, used);
+    } else {
+      stream->write(buffer, static_cast<std::streamsize>(used));
+    }
+    written += static_cast<double>(used);
+    used = 0;
+    scope.progress(std::min(written / expected, 1.0));
+  }
+};
+
+std::string SuperLong::toString(int base) const {
+  detail::UntracedScope untraced;
+  checkRadix(base);
+  if (isZero()) {
+    return "0";
+  }
+  std::string result;
+  if (sign == Sign::Negative) {
+    result += '-';
+  }
+
+  int bits = powerOfTwoBits(base);
+  if (bits > 0) {
+    size_t count = (bitLength() + bits - 1) / bits;
+    result.reserve(result.size() + count);
+    for (size_t d = count; d-- > 0;) {
+      size_t bit = d * bits;
+      n256plus window = digits[bit / 8];
+      if (bit / 8 + 1 < digits.size()) {
+        window |= static_cast<n256plus>(digits[bit / 8 + 1]) << 8;
+      }
+      result += kRadixDigits[(window >> (bit % 8)) & ((1u << bits) - 1)];
+    }
+    return result;
+  }
+
+  SuperLong magnitude {*this};
+  magnitude.sign = Sign::Positive;
+  radix_write(magnitude, base, result);
+  return result;
+}
+
+void SuperLong::radix_write(const SuperLong& magnitude, int base, std::string& out) {
+  DigitSink sink {&out, nullptr, expectedDigits(magnitude, base)};
+  radix_write(magnitude, base, sink);
+}
+
+void SuperLong::radix_write(const SuperLong& magnitude, int base, std::ostream& out) {
+  DigitSink sink {nullptr, &out, expectedDigits(magnitude, base)};
+  radix_write(magnitude, base, sink);
+}
+
+// Builds the power tree and its reciprocals, the only storage that grows
+// with the value besides the recursion's own halves, and streams the digits
+void SuperLong::radix_write(const SuperLong& magnitude, int base, DigitSink& sink) {
+  auto [chunkPower, chunkDigits] = radixChunk(base);
+  std::vector<SuperLong> powers {SuperLong {static_cast<int64_t>(chunkPower)}};
+  // Squares until powers.back()^2 >= 2^(2 bitLength - 2) exceeds the value,
+  // judged from bit lengths so the last square is never computed in vain
+  while (2 * (powers.back().bitLength() - 1) < magnitude.bitLength()) {
+    powers.push_back(powers.back() * powers.back());
+  }
+  std::vector<SuperLong> inverses;
+  for (const SuperLong& power : powers) {
+    inverses.push_back(reciprocal(power));
+  }
+  radix_emit(magnitude, powers, inverses, powers.size() - 1, base, 0, sink);
+  sink.finish();
+}
+
+// Writes x, which is below powers[level]^2, as exactly `width` digits, or
+// without padding when width is zero. inverses[k] is reciprocal(powers[k]),
+// so each split is a Barrett step and costs a few multiplications
+void SuperLong::radix_emit(const SuperLong& x, const std::vector<SuperLong>& powers,
+                           const std::vector<SuperLong>& inverses, size_t level, int base, size_t width,
+                           DigitSink& sink) {
+  auto [chunkPower, chunkDigits] = radixChunk(base);
+
+  if (x.digits.size() <= kRadixSplitLimbs) {
+    std::vector<uint32_t> chunks;
+    SuperLong temp {x};
+    do {
+      chunks.push_back(temp.divmodSmall(chunkPower));
+    } while (!temp.isZero());
+
+    size_t produced = chunks.size() * chunkDigits;
+    if (width > produced) {
+      sink.fill(width - produced);
+    }
+    char text[32];
+    for (size_t i = chunks.size(); i-- > 0;) {
+      bool top = (i + 1 == chunks.size());
+      sink.append(text, formatRadixChunk(chunks[i], base, (top && width == 0) ? 0 : chunkDigits, text));
+    }
+    return;
+  }
+
+  detail::checkpoint();
+  size_t lowDigits = chunkDigits << level;
+  auto [high, low] = divide_barrett(x, powers[level], inverses[level]);
+  if (width > 0) {
+    radix_emit(high, powers, inverses, level - 1, base, width - lowDigits, sink);
+  } else if (!high.isZero()) {
+    radix_emit(high, powers, inverses, level - 1, base, 0, sink);
+  }
+  radix_emit(low, powers, inverses, level - 1, base, (width > 0 || !high.isZero()) ? lowDigits : 0, sink);
+}
+
+SuperLong SuperLong::fromString(const std::string& str, int base) {
+  detail::UntracedScope untraced;
+  checkRadix(base);
+  if (str.empty()) {
+    throw std::invalid_argument("Input string cannot be empty");
+  }
+
+  size_t start = 0;
+  Sign parsedSign = Sign::Positive;
+  if (str[0] == '-' || str[0] == '+') {
+    parsedSign = (str[0] == '-') ? Sign::Negative : Sign::Positive;
+    start = 1;
+  }
+  if (start == str.size()) {
+    throw std::invalid_argument("Input string cannot be just a sign");
+  }
+  for (size_t i = start; i < str.size(); i++) {
+    if (digitValue(str[i]) >= base) {
+      throw std::invalid_argument("Input string contains invalid digits for the radix");
+    }
+  }
+
+  SuperLong result;
+  int bits = powerOfTwoBits(base);
+  if (bits > 0) {
+    result.digits.clear();
+    result.digits.reserve((str.size() - start) * bits / 8 + 1);
+    n256plus acc = 0;
+    int accBits = 0;
+    for (size_t i = str.size(); i-- > start;) {
+      acc |= static_cast<n256plus>(digitValue(str[i])) << accBits;
+      accBits += bits;
+      if (accBits >= 8) {
+        result.digits.push_back(static_cast<n256>(acc & 0xFF));
+        acc >>= 8;
+        accBits -= 8;
+      }
+    }
+    result.digits.push_back(static_cast<n256>(acc));
+  } else {
+    std::vector<SuperLong> powers;
+    result = radix_parse(str.data() + start, str.size() - start, base, powers);
+  }
+
+  result.sign = parsedSign;
+  result.removeLeadingZeros();
+  return result;
+}
+
+// powers[k] caches base^(chunkDigits * 2^k) across the recursion
+SuperLong SuperLong::radix_parse(const char* str, size_t len, int base, std::vector<SuperLong>& powers) {
+  auto [chunkPower, chunkDigits] = radixChunk(base);
+
+  if (len <= chunkDigits * kRadixSplitChunks) {
+    SuperLong result;
+    size_t head = len % chunkDigits;
+    size_t pos = 0;
+    while (pos < len) {
+      size_t take = (pos == 0 && head > 0) ? head : chunkDigits;
+      uint32_t chunk = 0;
+      uint32_t scale = 1;
+      for (size_t i = 0; i < take; i++) {
+        chunk = chunk * static_cast<uint32_t>(base) + static_cast<uint32_t>(digitValue(str[pos + i]));
+        scale *= static_cast<uint32_t>(base);
+      }
+      result.mulAddSmall(scale, chunk);
+      pos += take;
+    }
+    return result;
+  }
+
+  size_t level = 0;
+  while ((chunkDigits << (level + 1)) < len) {
+    level++;
+  }
+  if (powers.empty()) {
+    powers.push_back(SuperLong {static_cast<int64_t>(chunkPower)});
+  }
+  while (powers.size() <= level) {
+    powers.push_back(powers.back() * powers.back());
+  }
+
+  size_t lowDigits = chunkDigits << level;
+  SuperLong high = radix_parse(str, len - lowDigits, base, powers);
+  SuperLong low = radix_parse(str + len - lowDigits, lowDigits, base, powers);
+  return high * powers[level] + low;
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "superlong.hpp"
+
+namespace aoi {
+
+  namespace detail {
+
+    // Whole bytes of uniform output per generator call, or 0 when the
+    // generator's range is not [0, 2^k) and its output needs a distribution
+    template <class URBG>
+    constexpr size_t randomBytesPerCall() {
+      using Result = typename URBG::result_type;
+      if (URBG::min() != 0) {
+        return 0;
+      }
+      Result max = URBG::max();
+      size_t bits = 0;
+      while (max & 1) {
+        max >>= 1;
+        bits++;
+      }
+      return (max == 0) ? bits / 8 : 0;
+    }
+
+    template <class URBG>
+    void fillRandomLimbs(n256* out, size_t count, URBG& rng) {
+      constexpr size_t kBytes = randomBytesPerCall<URBG>();
+      if constexpr (kBytes > 0) {
+        for (size_t i = 0; i < count;) {
+          uint64_t word = static_cast<uint64_t>(rng());
+          for (size_t b = 0; b < kBytes && i < count; b++) {
+            out[i++] = static_cast<n256>(word);
+            word >>= 8;
+          }
+        }
+      } else {
+        std::uniform_int_distribution<uint32_t> words;
+        for (size_t i = 0; i < count;) {
+          uint32_t word = words(rng);
+          for (size_t b = 0; b < sizeof(uint32_t) && i < count; b++) {
+            out[i++] = static_cast<n256>(word);
+            word >>= 8;
+          }
+        }
+      }
+    }
+
+    inline size_t randomLimbCount(size_t nbits) {
+      return (nbits + 7) / 8;
+    }
+
+    inline n256 randomTopMask(size_t nbits) {
+      return (nbits % 8 == 0) ? n256 {0xFF} : static_cast<n256>((1u << (nbits % 8)) - 1);
+    }
+
+  }
+
+  // Uniform in [0, 2^nbits), written straight into the limbs
+  template <class URBG>
+  SuperLong random_bits(size_t nbits, URBG& rng) {
+    SuperLong result;
+    if (nbits == 0) {
+      return result;
+    }
+    size_t count = detail::randomLimbCount(nbits);
+    result.digits.resize(count);
+    n256* limbs = result.digits.data();
+    detail::fillRandomLimbs(limbs, count, rng);
+    limbs[count - 1] &= detail::randomTopMask(nbits);
+    result.removeLeadingZeros();
+    return result;
+  }
+
+  // Bulk form: the limbs of all `count` values are drawn in one pass over a
+  // shared buffer, so generator words are not wasted between values
+  template <class URBG>
+  void random_bits(SuperLong* values, size_t count, size_t nbits, URBG& rng) {
+    if (nbits == 0) {
+      for (size_t i = 0; i < count; i++) {
+        values[i] = SuperLong {};
+      }
+      return;
+    }
+    size_t limbCount = detail::randomLimbCount(nbits);
+    std::vector<n256> pool(count * limbCount);
+    detail::fillRandomLimbs(pool.data(), pool.size(), rng);
+    for (size_t i = 0; i < count; i++) {
+      n256* limbs = pool.data() + i * limbCount;
+      limbs[limbCount - 1] &= detail::randomTopMask(nbits);
+      values[i] = SuperLong {Sign::Positive, limbs, limbCount};
+    }
+  }
+
+  // Uniform in [0, bound) by rejection: draws of bound.bitLength() bits are
+  // retried while they reach bound, which takes fewer than two on average
+  template <class URBG>
+  SuperLong random_below(const SuperLong& bound, URBG& rng) {
+    if (bound.isNegative() || bound.isZero()) {
+      throw std::invalid_argument("Random bound must be positive");
+    }
+    size_t nbits = bound.bitLength();
+    SuperLong result = random_bits(nbits, rng);
+    while (result >= bound) {
+      result = random_bits(nbits, rng);
+    }
+    return result;
+  }
+
+  template <class URBG>
+  void random_below(SuperLong* values, size_t count, const SuperLong& bound, URBG& rng) {
+    if (bound.isNegative() || bound.isZero()) {
+      throw std::invalid_argument("Random bound must be positive");
+    }
+    size_t nbits = bound.bitLength();
+    random_bits(values, count, nbits, rng);
+    for (size_t i = 0; i < count; i++) {
+      while (values[i] >= bound) {
+        values[i] = random_bits(nbits, rng);
+      }
+    }
+  }
+
+}
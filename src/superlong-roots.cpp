@@ -0,0 +1,151 @@
+#include <array>
+#include <stdexcept>
+
+#include "superlong.hpp"
+#include "superlong-trace.hpp"
+
+using namespace aoi;
+
+static constexpr size_t kNativeRootBits = 64;
+
+static constexpr size_t kSquareFilterSize = 256;
+
+using SquareTable = std::array<bool, kSquareFilterSize + 1>;
+
+static constexpr SquareTable makeSquareTable(size_t modulus) {
+  SquareTable table {};
+  for (size_t x = 0; x < modulus; x++) {
+    table[(x * x) % modulus] = true;
+  }
+  return table;
+}
+
+// 256 is the limb base, 255 = 3 * 5 * 17 and 257 is prime, so all three
+// residues come straight out of the limbs without any bignum division
+static constexpr SquareTable kSquaresMod256 = makeSquareTable(256);
+static constexpr SquareTable kSquaresMod255 = makeSquareTable(255);
+static constexpr SquareTable kSquaresMod257 = makeSquareTable(257);
+
+static bool powLeq(uint64_t base, uint64_t k, uint64_t limit) {
+  uint64_t acc = 1;
+  for (uint64_t i = 0; i < k; i++) {
+    if (base != 0 && acc > limit / base) {
+      return false;
+    }
+    acc *= base;
+  }
+  return acc <= limit;
+}
+
+static uint64_t rootU64(uint64_t n, uint64_t k) {
+  if (k == 1 || n < 2) {
+    return n;
+  }
+  if (k >= kNativeRootBits) {
+    return 1;
+  }
+  uint64_t root = 0;
+  for (size_t bit = kNativeRootBits / k + 1; bit-- > 0;) {
+    uint64_t candidate = root | (uint64_t {1} << bit);
+    if (powLeq(candidate, k, n)) {
+      root = candidate;
+    }
+  }
+  return root;
+}
+
+static SuperLong power(const SuperLong& base, uint64_t exp) {
+  SuperLong result {1};
+  SuperLong square {base};
+  while (exp > 0) {
+    if (exp & 1) {
+      result *= square;
+    }
+    exp >>= 1;
+    if (exp > 0) {
+      square *= square;
+    }
+  }
+  return result;
+}
+
+// Floor k-th root of a positive value: the root of the top half of the bits
+// gives an overestimate that is already correct to half the precision. The
+// integer Newton step never drops below the root, so the first iterate
+// with x^k <= n is the root, usually after one or two full-size steps
+SuperLong SuperLong::root_positive(const SuperLong& n, uint64_t k) {
+  size_t bits = n.bitLength();
+  if (k >= bits) {
+    return SuperLong {1};
+  }
+
+  SuperLong x;
+  size_t shift = bits / k / 2;
+  if (bits <= kNativeRootBits) {
+    SuperLong root;
+    root.digits.clear();
+    root.initFromUint64(rootU64(n.lowWord(), k));
+    return root;
+  } else if (shift == 0) {
+    x = SuperLong {1} << (bits / k + 1);
+  } else {
+    x = (root_positive(n >> (k * shift), k) + 1LL) << shift;
+  }
+
+  SuperLong kk {static_cast<int64_t>(k)};
+  SuperLong km1 {static_cast<int64_t>(k - 1)};
+  SuperLong p = power(x, k - 1);
+  do {
+    x = (km1 * x + n / p) / kk;
+    p = power(x, k - 1);
+  } while (p * x > n);
+  return x;
+}
+
+SuperLong aoi::iroot(const SuperLong& n, uint64_t k) {
+  detail::UntracedScope untraced;
+  if (k == 0) {
+    throw std::invalid_argument("Root degree must be positive");
+  }
+  if (k == 1 || n.isZero()) {
+    return n;
+  }
+  if (n.isNegative()) {
+    if (k % 2 == 0) {
+      throw std::invalid_argument("Even root of negative number");
+    }
+    SuperLong root = SuperLong::root_positive(SuperLong(0LL) - n, k);
+    root.negate();
+    return root;
+  }
+  return SuperLong::root_positive(n, k);
+}
+
+SuperLong aoi::isqrt(const SuperLong& n) {
+  detail::UntracedScope untraced;
+  return iroot(n, 2);
+}
+
+bool aoi::is_perfect_square(const SuperLong& n) {
+  detail::UntracedScope untraced;
+  if (n.isNegative()) {
+    return false;
+  }
+  if (!kSquaresMod256[n.digits[0]]) {
+    return false;
+  }
+
+  // 256 = 1 (mod 255) and 256 = -1 (mod 257)
+  n256plus mod255 = 0;
+  n256plus mod257 = 0;
+  for (size_t i = n.digits.size(); i-- > 0;) {
+    mod255 = (mod255 + n.digits[i]) % 255;
+    mod257 = (mod257 * 256 + n.digits[i]) % 257;
+  }
+  if (!kSquaresMod255[mod255] || !kSquaresMod257[mod257]) {
+    return false;
+  }
+
+  SuperLong root = isqrt(n);
+  return root * root == n;
+}
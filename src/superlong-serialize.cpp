@@ -0,0 +1,171 @@
+#include <cstring>
+#include <stdexcept>
+
+#include "superlong.hpp"
+
+using namespace aoi;
+
+static constexpr uint8_t kSerialPositive = 0;
+static constexpr uint8_t kSerialNegative = 1;
+
+static void storeUint64(uint8_t* out, uint64_t value) {
+  for (size_t i = 0; i < sizeof(uint64_t); i++) {
+    out[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+}
+
+static uint64_t loadUint64(const uint8_t* in) {
+  uint64_t value = 0;
+  for (size_t i = sizeof(uint64_t); i-- > 0;) {
+    value = (value << 8) | in[i];
+  }
+  return value;
+}
+
+size_t SuperLong::serializedSize() const {
+  return kSerialHeaderSize + digits.size();
+}
+
+size_t SuperLong::serialize(uint8_t* out, size_t capacity) const {
+  size_t total = serializedSize();
+  if (capacity < total) {
+    throw std::invalid_argument("Output buffer is too small");
+  }
+  out[0] = (sign == Sign::Negative) ? kSerialNegative : kSerialPositive;
+  storeUint64(out + 1, digits.size());
+  std::memcpy(out + kSerialHeaderSize, digits.data(), digits.size());
+  return total;
+}
+
+SuperLong SuperLong::deserialize(const uint8_t* in, size_t size, size_t* consumed) {
+  return SuperLongView::parse(in, size, consumed).toSuperLong();
+}
+
+SuperLongView::SuperLongView(Sign sign, const n256* limbs, size_t count) : sign(sign), data(limbs), count(count) {
+}
+
+SuperLongView SuperLongView::parse(const uint8_t* in, size_t size, size_t* consumed) {
+  if (size < SuperLong::kSerialHeaderSize) {
+    throw std::invalid_argument("Serialized value is truncated");
+  }
+  if (in[0] != kSerialPositive && in[0] != kSerialNegative) {
+    throw std::invalid_argument("Serialized value has an invalid sign");
+  }
+  uint64_t count = loadUint64(in + 1);
+  if (count == 0 || count > size - SuperLong::kSerialHeaderSize) {
+    throw std::invalid_argument("Serialized value has an invalid limb count");
+  }
+
+  const n256* limbs = in + SuperLong::kSerialHeaderSize;
+  if (count > 1 && limbs[count - 1] == 0) {
+    throw std::invalid_argument("Serialized value has leading zero limbs");
+  }
+  if (count == 1 && limbs[0] == 0 && in[0] == kSerialNegative) {
+    throw std::invalid_argument("Serialized value is a negative zero");
+  }
+
+  if (consumed != nullptr) {
+    *consumed = SuperLong::kSerialHeaderSize + count;
+  }
+  return SuperLongView {in[0] == kSerialNegative ? Sign::Negative : Sign::Positive, limbs, count};
+}
+
+bool SuperLongView::isZero() const {
+  return count == 1 && data[0] == 0;
+}
+
+bool SuperLongView::isNegative() const {
+  return sign == Sign::Negative;
+}
+
+size_t SuperLongView::size() const {
+  return count;
+}
+
+const n256* SuperLongView::limbs() const {
+  return data;
+}
+
+SuperLong SuperLongView::toSuperLong() const {
+  SuperLong result;
+  result.sign = sign;
+  result.digits.assign(data, data + count);
+  result.removeLeadingZeros();
+  return result;
+}
+
+bool SuperLongView::operator==(const SuperLong& other) const {
+  return sign == other.sign && count == other.digits.size() && std::memcmp(data, other.digits.data(), count) == 0;
+}
+
+bool SuperLongView::operator!=(const SuperLong& other) const {
+  return !(*this == other);
+}
+
+int SuperLongView::compare(const SuperLongView& other) const {
+  if (sign != other.sign) {
+    return (sign == Sign::Negative) ? -1 : 1;
+  }
+  int magnitude = 0;
+  if (count != other.count) {
+    magnitude = (count < other.count) ? -1 : 1;
+  } else {
+    for (size_t i = count; i-- > 0;) {
+      if (data[i] != other.data[i]) {
+        magnitude = (data[i] < other.data[i]) ? -1 : 1;
+        break;
+      }
+    }
+  }
+  return (sign == Sign::Negative) ? -magnitude : magnitude;
+}
+
+SuperLongArrayView::SuperLongArrayView(const uint8_t* data, size_t size) : data(data), size(size) {
+}
+
+SuperLongArrayView::Iterator SuperLongArrayView::begin() const {
+  return Iterator {data, data + size};
+}
+
+SuperLongArrayView::Iterator SuperLongArrayView::end() const {
+  return Iterator {data + size, data + size};
+}
+
+SuperLongArrayView::Iterator::Iterator(const uint8_t* pos, const uint8_t* end)
+    : pos(pos), end(end), length(0), current(Sign::Positive, nullptr, 0) {
+  load();
+}
+
+void SuperLongArrayView::Iterator::load() {
+  if (pos != end) {
+    current = SuperLongView::parse(pos, static_cast<size_t>(end - pos), &length);
+  }
+}
+
+SuperLongArrayView::Iterator::reference SuperLongArrayView::Iterator::operator*() const {
+  return current;
+}
+
+SuperLongArrayView::Iterator::pointer SuperLongArrayView::Iterator::operator->() const {
+  return &current;
+}
+
+SuperLongArrayView::Iterator& SuperLongArrayView::Iterator::operator++() {
+  pos += length;
+  load();
+  return *this;
+}
+
+SuperLongArrayView::Iterator SuperLongArrayView::Iterator::operator++(int) {
+  Iterator temp = *this;
+  ++*this;
+  return temp;
+}
+
+bool SuperLongArrayView::Iterator::operator==(const Iterator& other) const {
+  return pos == other.pos;
+}
+
+bool SuperLongArrayView::Iterator::operator!=(const Iterator& other) const {
+  return pos != other.pos;
+}
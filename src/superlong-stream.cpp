@@ -0,0 +1,150 @@
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "superlong.hpp"
+#include "superlong-trace.hpp"
+
+using namespace aoi;
+
+static constexpr uint32_t kDecimalChunk = 1000000000;
+static constexpr size_t kDecimalChunkDigits = 9;
+
+// Extraction converts the digits in blocks of 9 * 2^kDecimalBlockLevel, so
+// that two adjacent runs of 2^k blocks join through a power of ten the
+// radix parser caches anyway
+static constexpr size_t kDecimalBlockLevel = 9;
+static constexpr size_t kDecimalBlockDigits = kDecimalChunkDigits << kDecimalBlockLevel;
+
+// 10^(kDecimalBlockDigits * 2^level), the factor that joins two runs of
+// 2^level blocks
+static const SuperLong& blockPower(std::vector<SuperLong>& powers, size_t level) {
+  while (powers.size() <= kDecimalBlockLevel + level) {
+    powers.push_back(powers.back() * powers.back());
+  }
+  return powers[kDecimalBlockLevel + level];
+}
+
+// Digits go out through a fixed-size buffer as the divide-and-conquer
+// split produces them, so no decimal string is ever built
+std::ostream& aoi::operator<<(std::ostream& os, const SuperLong& value) {
+  detail::UntracedScope untraced;
+  if (value.sign == Sign::Negative) {
+    os.put('-');
+  }
+  SuperLong magnitude {value};
+  magnitude.sign = Sign::Positive;
+  SuperLong::radix_write(magnitude, 10, os);
+  return os;
+}
+
+// Follows the string constructor: an optional '+' or '-' followed by decimal
+// digits, with leading zeros allowed. Digits are read straight from the
+// stream buffer into one fixed-size block at a time; each full block is
+// converted on its own and joined to the blocks before it like a binary
+// counter, so runs of 2^k blocks merge with one balanced multiplication
+std::istream& aoi::operator>>(std::istream& is, SuperLong& value) {
+  detail::UntracedScope untraced;
+  using Traits = std::istream::traits_type;
+
+  std::istream::sentry guard(is);
+  if (!guard) {
+    return is;
+  }
+  std::streambuf* buf = is.rdbuf();
+
+  Sign sign = Sign::Positive;
+  Traits::int_type c = buf->sgetc();
+  if (c == Traits::to_int_type('-') || c == Traits::to_int_type('+')) {
+    sign = (c == Traits::to_int_type('-')) ? Sign::Negative : Sign::Positive;
+    c = buf->snextc();
+  }
+
+  // powers[k] is 10^(9 * 2^k), shared with the block conversions
+  std::vector<SuperLong> powers {SuperLong {static_cast<int64_t>(kDecimalChunk)}};
+  // Converted runs of 2^level blocks, most significant first
+  std::vector<std::pair<SuperLong, size_t>> runs;
+  char block[kDecimalBlockDigits];
+  size_t used = 0;
+  bool anyDigits = false;
+  while (!Traits::eq_int_type(c, Traits::eof()) && c >= '0' && c <= '9') {
+    anyDigits = true;
+    block[used++] = static_cast<char>(c);
+    if (used == kDecimalBlockDigits) {
+      SuperLong run = SuperLong::radix_parse(block, used, 10, powers);
+      size_t level = 0;
+      while (!runs.empty() && runs.back().second == level) {
+        run = runs.back().first * blockPower(powers, level) + run;
+        runs.pop_back();
+        level++;
+      }
+      runs.emplace_back(std::move(run), level);
+      used = 0;
+    }
+    c = buf->snextc();
+  }
+
+  if (Traits::eq_int_type(c, Traits::eof())) {
+    is.setstate(std::ios_base::eofbit);
+  }
+  if (!anyDigits) {
+    is.setstate(std::ios_base::failbit);
+    return is;
+  }
+
+  // The partial block is the least significant; each run above it is
+  // shifted past everything below, smallest runs first
+  SuperLong result = (used > 0) ? SuperLong::radix_parse(block, used, 10, powers) : SuperLong {};
+  SuperLong scale {1};
+  for (size_t i = 0; i < used / kDecimalChunkDigits; i++) {
+    scale.mulAddSmall(kDecimalChunk, 0);
+  }
+  uint32_t rest = 1;
+  for (size_t i = 0; i < used % kDecimalChunkDigits; i++) {
+    rest *= 10;
+  }
+  scale.mulAddSmall(rest, 0);
+  for (size_t i = runs.size(); i-- > 0;) {
+    result = runs[i].first * scale + result;
+    if (i > 0) {
+      scale = scale * blockPower(powers, runs[i].second);
+    }
+  }
+
+  result.sign = sign;
+  result.removeLeadingZeros();
+  value = std::move(result);
+  return is;
+}
+
+void aoi::writeDecimalFile(const std::string& path, const SuperLong& value) {
+  detail::UntracedScope untraced;
+  std::ofstream out(path, std::ios::binary);
+  if (!out) {
+    throw std::runtime_error("Cannot open file for writing: " + path);
+  }
+  out << value << '\n';
+  if (!out) {
+    throw std::runtime_error("Failed to write file: " + path);
+  }
+}
+
+SuperLong aoi::readDecimalFile(const std::string& path) {
+  detail::UntracedScope untraced;
+  std::ifstream in(path, std::ios::binary);
+  if (!in) {
+    throw std::runtime_error("Cannot open file for reading: " + path);
+  }
+  SuperLong value;
+  if (!(in >> value)) {
+    throw std::invalid_argument("File does not start with a decimal number: " + path);
+  }
+  in >> std::ws;
+  if (!in.eof()) {
+    throw std::invalid_argument("File contains non-digit characters: " + path);
+  }
+  return value;
+}
@@ -0,0 +1,174 @@
+#include "superlong-trace.hpp"
+
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+
+using namespace aoi;
+
+static constexpr char kTraceMagic[] = "SLTRACE1";
+static constexpr size_t kTraceMagicSize = sizeof(kTraceMagic) - 1;
+static constexpr size_t kRecordHeaderSize = 2 + 2 * sizeof(uint64_t);
+static constexpr uint8_t kHasOperands = 1;
+
+std::atomic<bool> detail::traceActive {false};
+
+static std::mutex traceMutex;
+static std::FILE* traceFile = nullptr;
+static std::atomic<bool> traceOperands {false};
+
+static thread_local unsigned traceDepth = 0;
+
+static void storeUint64(uint8_t* out, uint64_t value) {
+  for (size_t i = 0; i < sizeof(uint64_t); i++) {
+    out[i] = static_cast<uint8_t>(value >> (8 * i));
+  }
+}
+
+static uint64_t loadUint64(const uint8_t* in) {
+  uint64_t value = 0;
+  for (size_t i = sizeof(uint64_t); i-- > 0;) {
+    value = (value << 8) | in[i];
+  }
+  return value;
+}
+
+static uint64_t limbCount(const SuperLong& value) {
+  return value.serializedSize() - SuperLong::kSerialHeaderSize;
+}
+
+static void appendOperand(std::vector<uint8_t>& out, const SuperLong& value) {
+  size_t offset = out.size();
+  out.resize(offset + value.serializedSize());
+  value.serialize(out.data() + offset, out.size() - offset);
+}
+
+void aoi::startTrace(const std::string& path, bool recordOperands) {
+  std::lock_guard<std::mutex> lock(traceMutex);
+  if (traceFile != nullptr) {
+    std::fclose(traceFile);
+  }
+  traceFile = std::fopen(path.c_str(), "wb");
+  if (traceFile == nullptr) {
+    detail::traceActive.store(false, std::memory_order_relaxed);
+    throw std::runtime_error("Cannot open file for writing: " + path);
+  }
+  std::fwrite(kTraceMagic, 1, kTraceMagicSize, traceFile);
+  traceOperands = recordOperands;
+  detail::traceActive.store(true, std::memory_order_relaxed);
+}
+
+void aoi::stopTrace() {
+  detail::traceActive.store(false, std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lock(traceMutex);
+  if (traceFile != nullptr) {
+    std::fclose(traceFile);
+    traceFile = nullptr;
+  }
+}
+
+bool aoi::isTracing() {
+  return detail::traceActive.load(std::memory_order_relaxed);
+}
+
+const char* aoi::traceOpName(TraceOp op) {
+  switch (op) {
+    case TraceOp::Add:
+      return "add";
+    case TraceOp::Subtract:
+      return "subtract";
+    case TraceOp::Multiply:
+      return "multiply";
+    case TraceOp::Divide:
+      return "divide";
+    case TraceOp::Modulo:
+      return "modulo";
+    case TraceOp::ToString:
+      return "toString";
+  }
+  return "unknown";
+}
+
+void detail::TraceScope::enter(TraceOp op, const SuperLong& a, const SuperLong* b) {
+  armed = true;
+  if (traceDepth++ > 0) {
+    return;
+  }
+
+  // Built outside the lock; the record is written in one call
+  static thread_local std::vector<uint8_t> record;
+  bool withOperands = traceOperands.load(std::memory_order_relaxed);
+  record.assign(kRecordHeaderSize, 0);
+  record[0] = static_cast<uint8_t>(op);
+  record[1] = withOperands ? kHasOperands : 0;
+  storeUint64(record.data() + 2, limbCount(a));
+  storeUint64(record.data() + 2 + sizeof(uint64_t), (b != nullptr) ? limbCount(*b) : 0);
+  if (withOperands) {
+    appendOperand(record, a);
+    if (b != nullptr) {
+      appendOperand(record, *b);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(traceMutex);
+  if (traceFile != nullptr) {
+    std::fwrite(record.data(), 1, record.size(), traceFile);
+  }
+}
+
+void detail::TraceScope::leave() {
+  traceDepth--;
+}
+
+void detail::UntracedScope::enter() {
+  armed = true;
+  traceDepth++;
+}
+
+void detail::UntracedScope::leave() {
+  traceDepth--;
+}
+
+TraceReader::TraceReader(const std::string& path) : file(std::fopen(path.c_str(), "rb")), path(path) {
+  if (file == nullptr) {
+    throw std::runtime_error("Cannot open file for reading: " + path);
+  }
+  char magic[kTraceMagicSize];
+  if (std::fread(magic, 1, kTraceMagicSize, file) != kTraceMagicSize ||
+      std::memcmp(magic, kTraceMagic, kTraceMagicSize) != 0) {
+    std::fclose(file);
+    throw std::invalid_argument("Not a trace file: " + path);
+  }
+}
+
+TraceReader::~TraceReader() {
+  std::fclose(file);
+}
+
+bool TraceReader::next(TraceRecord& record) {
+  uint8_t header[kRecordHeaderSize];
+  size_t got = std::fread(header, 1, kRecordHeaderSize, file);
+  if (got == 0) {
+    return false;
+  }
+  if (got != kRecordHeaderSize || header[0] > static_cast<uint8_t>(TraceOp::ToString)) {
+    throw std::invalid_argument("Trace record is malformed: " + path);
+  }
+  record.op = static_cast<TraceOp>(header[0]);
+  record.hasOperands = (header[1] & kHasOperands) != 0;
+  record.sizeA = loadUint64(header + 2);
+  record.sizeB = loadUint64(header + 2 + sizeof(uint64_t));
+  if (record.hasOperands) {
+    record.a = readOperand(record.sizeA);
+    record.b = (record.sizeB > 0) ? readOperand(record.sizeB) : SuperLong {};
+  }
+  return true;
+}
+
+SuperLong TraceReader::readOperand(uint64_t size) {
+  buffer.resize(SuperLong::kSerialHeaderSize + size);
+  if (std::fread(buffer.data(), 1, buffer.size(), file) != buffer.size()) {
+    throw std::invalid_argument("Trace record is malformed: " + path);
+  }
+  return SuperLong::deserialize(buffer.data(), buffer.size());
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "superlong.hpp"
+
+namespace aoi {
+
+  enum class TraceOp : uint8_t { Add, Subtract, Multiply, Divide, Modulo, ToString };
+
+  // Trace file: the 8-byte magic "SLTRACE1", then one record per operation:
+  // op byte, operand flag byte, both operand limb counts as little-endian
+  // uint64, and when the flag is set the operands in the serialize() format.
+  // Unary operations record a second size of zero and no second operand
+  struct TraceRecord {
+    TraceOp op;
+    uint64_t sizeA;
+    uint64_t sizeB;
+    bool hasOperands;
+    SuperLong a;
+    SuperLong b;
+  };
+
+  // Records every SuperLong arithmetic operator and toString() call made by
+  // any thread until stopTrace(). Calls made inside another traced call, or
+  // inside any other library function (gcd, isqrt, SuperRational, SuperFloat,
+  // Montgomery and the rest), are not recorded, so the trace holds the
+  // application's own SuperLong operations rather than the library's. Work
+  // done through those other functions does not appear in the trace at all
+  void startTrace(const std::string& path, bool recordOperands = false);
+  void stopTrace();
+  bool isTracing();
+
+  const char* traceOpName(TraceOp op);
+
+  class TraceReader {
+   public:
+    explicit TraceReader(const std::string& path);
+    ~TraceReader();
+
+    TraceReader(const TraceReader&) = delete;
+    TraceReader& operator=(const TraceReader&) = delete;
+
+    // Returns false at the end of the trace
+    bool next(TraceRecord& record);
+
+   private:
+    std::FILE* file;
+    std::string path;
+    std::vector<uint8_t> buffer;
+
+    SuperLong readOperand(uint64_t size);
+  };
+
+  namespace detail {
+
+    extern std::atomic<bool> traceActive;
+
+    class TraceScope {
+     public:
+      // The disabled path is a single relaxed load
+      TraceScope(TraceOp op, const SuperLong& a, const SuperLong* b = nullptr) : armed(false) {
+        if (traceActive.load(std::memory_order_relaxed)) {
+          enter(op, a, b);
+        }
+      }
+
+      ~TraceScope() {
+        if (armed) {
+          leave();
+        }
+      }
+
+      TraceScope(const TraceScope&) = delete;
+      TraceScope& operator=(const TraceScope&) = delete;
+
+     private:
+      bool armed;
+
+      void enter(TraceOp op, const SuperLong& a, const SuperLong* b);
+      void leave();
+    };
+
+    // Entry guard for library functions that are not traced themselves, so
+    // the operators they use internally are not recorded either
+    class UntracedScope {
+     public:
+      UntracedScope() : armed(false) {
+        if (traceActive.load(std::memory_order_relaxed)) {
+          enter();
+        }
+      }
+
+      ~UntracedScope() {
+        if (armed) {
+          leave();
+        }
+      }
+
+      UntracedScope(const UntracedScope&) = delete;
+      UntracedScope& operator=(const UntracedScope&) = delete;
+
+     private:
+      bool armed;
+
+      void enter();
+      void leave();
+    };
+
+  }
+
+}
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <cstring>
+
 #include "superlong.hpp"
 
 using namespace aoi;
@@ -26,3 +29,59 @@ void SuperLong::removeLeadingZeros() {
     sign = Sign::Positive;
   }
 }
+
+size_t SuperLong::bitLength() const {
+  if (isZero()) {
+    return 0;
+  }
+  size_t bits = (digits.size() - 1) * 8;
+  for (n256 top = digits.back(); top > 0; top >>= 1) {
+    bits++;
+  }
+  return bits;
+}
+
+uint64_t SuperLong::lowWord() const {
+  uint64_t word = 0;
+  for (size_t i = std::min(digits.size(), sizeof(uint64_t)); i-- > 0;) {
+    word = (word << 8) | digits[i];
+  }
+  return word;
+}
+
+static constexpr uint64_t kHashPrime1 = 0x9E3779B185EBCA87;
+static constexpr uint64_t kHashPrime2 = 0xC2B2AE3D27D4EB4F;
+static constexpr uint64_t kHashPrime3 = 0x165667B19E3779F9;
+
+static uint64_t rotl64(uint64_t x, int r) {
+  return (x << r) | (x >> (64 - r));
+}
+
+// xxHash64-style rounds over the limbs eight at a time. Values are kept
+// normalized, so equal numbers always have identical limbs
+size_t SuperLong::hash() const noexcept {
+  const n256* data = digits.data();
+  size_t size = digits.size();
+
+  uint64_t h = kHashPrime3 ^ (size * kHashPrime1) ^ (sign == Sign::Negative ? kHashPrime2 : 0);
+  size_t i = 0;
+  for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+    uint64_t word;
+    std::memcpy(&word, data + i, sizeof(word));
+    h ^= rotl64(word * kHashPrime2, 31) * kHashPrime1;
+    h = rotl64(h, 27) * kHashPrime1 + kHashPrime3;
+  }
+  if (i < size) {
+    uint64_t word = 0;
+    std::memcpy(&word, data + i, size - i);
+    h ^= rotl64(word * kHashPrime2, 31) * kHashPrime1;
+    h = rotl64(h, 27) * kHashPrime1 + kHashPrime3;
+  }
+
+  h ^= h >> 33;
+  h *= kHashPrime2;
+  h ^= h >> 29;
+  h *= kHashPrime3;
+  h ^= h >> 32;
+  return static_cast<size_t>(h);
+}
@@ -1,7 +1,20 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cstddef>
 #include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -12,11 +25,231 @@ namespace aoi {
 
   enum class Sign { Positive, Negative };
 
+  // Reference-counted limb storage with a std::vector-like interface. Copies
+  // share the buffer; any non-const access first detaches it, so hot loops
+  // should take data() once rather than index a non-const buffer repeatedly.
+  // The count is atomic and a writer only skips the detach after an acquire
+  // load sees it as the sole owner, so copies may be handed to other threads
+  // while the original is still read or written
+  class LimbBuffer {
+   public:
+    using value_type = n256;
+    using iterator = n256*;
+    using const_iterator = const n256*;
+
+    LimbBuffer() = default;
+
+    LimbBuffer(size_t count, n256 value) : block(new Block(std::vector<n256>(count, value))) {
+    }
+
+    LimbBuffer(std::initializer_list<n256> limbs) : block(new Block(std::vector<n256>(limbs))) {
+    }
+
+    template <typename InputIt>
+    LimbBuffer(InputIt first, InputIt last) : block(new Block(std::vector<n256>(first, last))) {
+    }
+
+    LimbBuffer(const LimbBuffer& other) : block(other.block) {
+      if (block) {
+        block->refs.fetch_add(1, std::memory_order_relaxed);
+      }
+    }
+
+    LimbBuffer(LimbBuffer&& other) noexcept : block(other.block) {
+      other.block = nullptr;
+    }
+
+    LimbBuffer& operator=(const LimbBuffer& other) {
+      LimbBuffer copy {other};
+      std::swap(block, copy.block);
+      return *this;
+    }
+
+    LimbBuffer& operator=(LimbBuffer&& other) noexcept {
+      std::swap(block, other.block);
+      return *this;
+    }
+
+    ~LimbBuffer() {
+      release();
+    }
+
+    size_t size() const {
+      return block ? block->limbs.size() : 0;
+    }
+
+    bool empty() const {
+      return size() == 0;
+    }
+
+    bool isShared() const {
+      return block && block->refs.load(std::memory_order_acquire) > 1;
+    }
+
+    const n256* data() const {
+      return block ? block->limbs.data() : nullptr;
+    }
+
+    n256* data() {
+      return unique().data();
+    }
+
+    const n256& operator[](size_t i) const {
+      return block->limbs[i];
+    }
+
+    n256& operator[](size_t i) {
+      return unique()[i];
+    }
+
+    const n256& back() const {
+      return block->limbs.back();
+    }
+
+    n256& back() {
+      return unique().back();
+    }
+
+    const_iterator begin() const {
+      return data();
+    }
+
+    const_iterator end() const {
+      return data() + size();
+    }
+
+    iterator begin() {
+      return data();
+    }
+
+    iterator end() {
+      return data() + size();
+    }
+
+    void reserve(size_t count) {
+      unique().reserve(count);
+    }
+
+    void push_back(n256 limb) {
+      unique().push_back(limb);
+    }
+
+    void pop_back() {
+      unique().pop_back();
+    }
+
+    void resize(size_t count, n256 value = 0) {
+      unique().resize(count, value);
+    }
+
+    // Replacing the contents never copies a shared buffer first
+    void clear() {
+      if (isShared()) {
+        release();
+      } else if (block) {
+        block->limbs.clear();
+      }
+    }
+
+    void assign(size_t count, n256 value) {
+      if (isShared() || !block) {
+        release();
+        block = new Block(std::vector<n256>(count, value));
+      } else {
+        block->limbs.assign(count, value);
+      }
+    }
+
+    template <typename InputIt>
+    void assign(InputIt first, InputIt last) {
+      Block* replacement = new Block(std::vector<n256>(first, last));
+      release();
+      block = replacement;
+    }
+
+    iterator insert(const_iterator pos, size_t count, n256 value) {
+      size_t index = static_cast<size_t>(pos - begin());
+      std::vector<n256>& limbs = unique();
+      limbs.insert(limbs.begin() + index, count, value);
+      return limbs.data() + index;
+    }
+
+    iterator erase(const_iterator first, const_iterator last) {
+      size_t from = static_cast<size_t>(first - begin());
+      size_t to = static_cast<size_t>(last - begin());
+      std::vector<n256>& limbs = unique();
+      limbs.erase(limbs.begin() + from, limbs.begin() + to);
+      return limbs.data() + from;
+    }
+
+    bool operator==(const LimbBuffer& other) const {
+      if (block == other.block) {
+        return true;
+      }
+      return size() == other.size() && std::equal(begin(), end(), other.begin());
+    }
+
+    bool operator!=(const LimbBuffer& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    struct Block {
+      explicit Block(std::vector<n256> limbs) : limbs(std::move(limbs)) {
+      }
+
+      std::atomic<size_t> refs {1};
+      std::vector<n256> limbs;
+    };
+
+    Block* block = nullptr;
+
+    // The release half orders this owner's reads before whichever owner
+    // frees or detaches the block; the acquire half is for the one that frees
+    void release() {
+      if (block && block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete block;
+      }
+      block = nullptr;
+    }
+
+    std::vector<n256>& unique() {
+      if (!block) {
+        block = new Block(std::vector<n256>());
+      } else if (isShared()) {
+        Block* copy = new Block(block->limbs);
+        release();
+        block = copy;
+      }
+      return block->limbs;
+    }
+  };
+
+  class SuperLongView;
+  class Accumulator;
+  class MappedSuperLong;
+  class SuperFloat;
+  class ResidueBasis;
+  class Montgomery;
+  class SuperLongVector;
+  class DecimalSuperLong;
+  template <size_t Bits>
+  class FixedSuperLong;
+
   class SuperLong {
    public:
     SuperLong();
     SuperLong(int64_t num);
-    SuperLong(const std::string& str);
+    SuperLong(std::string_view str);
+    // std::string and other types that convert to std::string_view, taking
+    // one conversion like the std::string constructor used to. Character
+    // arrays and pointers go to the std::string_view overload directly
+    template <typename Text,
+              std::enable_if_t<std::is_convertible_v<const Text&, std::string_view> &&
+                                   !std::is_convertible_v<const Text&, const char*>,
+                               int> = 0>
+    SuperLong(const Text& str) : SuperLong(std::string_view {str}) {
+    }
     SuperLong(const SuperLong& other);
     SuperLong(SuperLong&& other) noexcept;
     ~SuperLong() = default;
@@ -26,6 +259,7 @@ namespace aoi {
 
     SuperLong operator+(const SuperLong& other) const;
     SuperLong operator-(const SuperLong& other) const;
+    SuperLong operator-() const;
     SuperLong& operator+=(const SuperLong& other);
     SuperLong& operator-=(const SuperLong& other);
     SuperLong& operator--();
@@ -58,15 +292,68 @@ namespace aoi {
     bool isNegative() const;
     bool isPositive() const;
 
+    size_t bitLength() const;
+    size_t hash() const noexcept;
+
     std::string toString() const;
+    std::string toString(int base) const;
+    static SuperLong fromString(const std::string& str, int base);
+
+    friend std::ostream& operator<<(std::ostream& os, const SuperLong& value);
+    friend std::istream& operator>>(std::istream& is, SuperLong& value);
+
+    friend std::from_chars_result from_chars(const char* first, const char* last, SuperLong& value);
+
+    // Wire format: sign byte (0 or 1), limb count as little-endian uint64,
+    // then the base-256 limbs from least to most significant
+    static constexpr size_t kSerialHeaderSize = 1 + sizeof(uint64_t);
+
+    size_t serializedSize() const;
+    size_t serialize(uint8_t* out, size_t capacity) const;
+    static SuperLong deserialize(const uint8_t* in, size_t size, size_t* consumed = nullptr);
+
+    friend SuperLong isqrt(const SuperLong& n);
+    friend SuperLong iroot(const SuperLong& n, uint64_t k);
+    friend bool is_perfect_square(const SuperLong& n);
+
+    friend SuperLong gcd(const SuperLong& a, const SuperLong& b);
+    friend std::tuple<SuperLong, SuperLong, SuperLong> xgcd(const SuperLong& a, const SuperLong& b);
+
+    friend SuperLong divexact(const SuperLong& a, const SuperLong& b);
+
+    friend bool is_probable_prime(const SuperLong& n, int rounds);
+    friend SuperLong next_prime(const SuperLong& n);
 
 
    private:
+    friend class SuperLongView;
+    template <char... Chars>
+    friend SuperLong operator"" _sl();
+
+    SuperLong(Sign sign, const n256* limbs, size_t count);
+    friend class Accumulator;
+    friend class MappedSuperLong;
+    friend class SuperFloat;
+    friend class ResidueBasis;
+    friend class Montgomery;
+    friend class SuperLongVector;
+    friend class DecimalSuperLong;
+    template <class URBG>
+    friend SuperLong random_bits(size_t nbits, URBG& rng);
+    template <class URBG>
+    friend void random_bits(SuperLong* values, size_t count, size_t nbits, URBG& rng);
+    template <size_t Bits>
+    friend class FixedSuperLong;
+
     Sign sign;
-    std::vector<n256> digits;
+    LimbBuffer digits;
 
     void removeLeadingZeros();
     void initFromUint64(uint64_t num);
+    uint64_t lowWord() const;
+
+    uint32_t divmodSmall(uint32_t divisor);
+    void mulAddSmall(uint32_t factor, uint32_t addend);
 
     static int abscmp(const SuperLong& a, const SuperLong& b);
 
@@ -79,13 +366,247 @@ namespace aoi {
     static SuperLong multiply(const SuperLong& a, const SuperLong& b);
     static SuperLong multiply_simple(const SuperLong& a, const SuperLong& b);
     static SuperLong multiply_karatsuba(const SuperLong& a, const SuperLong& b);
+    static SuperLong multiply_unbalanced(const SuperLong& longer, const SuperLong& shorter);
+    static SuperLong multiply_toom32(const SuperLong& longer, const SuperLong& shorter);
 
     static std::pair<SuperLong, SuperLong> divide_quo_rem(const SuperLong& a, const SuperLong& b);
+    static std::pair<SuperLong, SuperLong> divide_newton(const SuperLong& a, const SuperLong& d);
+    static std::pair<SuperLong, SuperLong> divide_barrett(const SuperLong& a, const SuperLong& d, const SuperLong& v);
+    static SuperLong reciprocal(const SuperLong& d);
+
+    static SuperLong root_positive(const SuperLong& n, uint64_t k);
+
+    static std::array<SuperLong, 4> lehmer_step(SuperLong& u, SuperLong& v);
+    static std::array<SuperLong, 4> half_gcd(SuperLong& a, SuperLong& b);
+
+    class DigitSink;
+    static void radix_write(const SuperLong& magnitude, int base, std::string& out);
+    static void radix_write(const SuperLong& magnitude, int base, std::ostream& out);
+    static void radix_write(const SuperLong& magnitude, int base, DigitSink& sink);
+    static void radix_emit(const SuperLong& x, const std::vector<SuperLong>& powers,
+                           const std::vector<SuperLong>& inverses, size_t level, int base, size_t width,
+                           DigitSink& sink);
+    static SuperLong radix_parse(const char* str, size_t len, int base, std::vector<SuperLong>& powers);
 
     SuperLong multi256n(size_t shift) const;
     SuperLong divid256n(size_t shift) const;
+    SuperLong mod256n(size_t shift) const;
+  };
+
+  // Non-owning, read-only view of a number stored elsewhere, e.g. inside a
+  // memory-mapped file of serialized values
+  class SuperLongView {
+   public:
+    SuperLongView(Sign sign, const n256* limbs, size_t count);
+
+    static SuperLongView parse(const uint8_t* in, size_t size, size_t* consumed = nullptr);
+
+    bool isZero() const;
+    bool isNegative() const;
+    size_t size() const;
+    const n256* limbs() const;
+
+    SuperLong toSuperLong() const;
+
+    bool operator==(const SuperLong& other) const;
+    bool operator!=(const SuperLong& other) const;
+    // Returns -1, 0 or 1; both views must be free of leading zero limbs
+    int compare(const SuperLongView& other) const;
+
+   private:
+    Sign sign;
+    const n256* data;
+    size_t count;
+  };
+
+  // Iterates over a buffer of back-to-back serialized numbers without copying
+  class SuperLongArrayView {
+   public:
+    class Iterator {
+     public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = SuperLongView;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const SuperLongView*;
+      using reference = const SuperLongView&;
+
+      Iterator(const uint8_t* pos, const uint8_t* end);
+
+      reference operator*() const;
+      pointer operator->() const;
+      Iterator& operator++();
+      Iterator operator++(int);
+
+      bool operator==(const Iterator& other) const;
+      bool operator!=(const Iterator& other) const;
+
+     private:
+      const uint8_t* pos;
+      const uint8_t* end;
+      size_t length;
+      SuperLongView current;
+
+      void load();
+    };
+
+    SuperLongArrayView(const uint8_t* data, size_t size);
+
+    Iterator begin() const;
+    Iterator end() const;
+
+   private:
+    const uint8_t* data;
+    size_t size;
+  };
+
+  // Running signed sum kept in 64-bit limbs that each hold a base-256 digit
+  // plus headroom. Carries are only propagated when the total is read or a
+  // limb runs out of headroom, not after every addition
+  class Accumulator {
+   public:
+    Accumulator();
+
+    Accumulator& operator+=(const SuperLong& value);
+    Accumulator& operator-=(const SuperLong& value);
+
+    void add(const SuperLong& value);
+    void subtract(const SuperLong& value);
+    void addProduct(const SuperLong& a, const SuperLong& b);
+
+    SuperLong value() const;
+    void reset();
+
+   private:
+    std::vector<uint64_t> positive;
+    std::vector<uint64_t> negative;
+    uint64_t positiveLoad;
+    uint64_t negativeLoad;
+
+    static void reserveLoad(std::vector<uint64_t>& limbs, uint64_t& load, uint64_t increment);
+    static void normalize(std::vector<uint64_t>& limbs);
+    static SuperLong settle(const std::vector<uint64_t>& limbs);
   };
 
   SuperLong operator"" _sl(const char* str, size_t len);
 
+  namespace literal {
+
+    template <size_t N>
+    struct ParsedLimbs {
+      std::array<n256, N> limbs;
+      size_t count;
+    };
+
+    // Follows C++ integer literal rules: 0x/0X hex, 0b/0B binary, a leading
+    // 0 for octal, otherwise decimal, with ' digit separators allowed
+    template <size_t N, char... Chars>
+    constexpr ParsedLimbs<N> parse() {
+      constexpr char chars[] = {Chars...};
+      constexpr size_t len = sizeof...(Chars);
+
+      n256plus base = 10;
+      size_t pos = 0;
+      if (len > 1 && chars[0] == '0') {
+        if (chars[1] == 'x' || chars[1] == 'X') {
+          base = 16;
+          pos = 2;
+        } else if (chars[1] == 'b' || chars[1] == 'B') {
+          base = 2;
+          pos = 2;
+        } else {
+          base = 8;
+          pos = 1;
+        }
+      }
+
+      ParsedLimbs<N> parsed {{}, 1};
+      for (; pos < len; pos++) {
+        char c = chars[pos];
+        if (c == '\'') {
+          continue;
+        }
+        n256plus digit = (c >= '0' && c <= '9')   ? static_cast<n256plus>(c - '0')
+                         : (c >= 'a' && c <= 'f') ? static_cast<n256plus>(c - 'a' + 10)
+                         : (c >= 'A' && c <= 'F') ? static_cast<n256plus>(c - 'A' + 10)
+                                                  : base;
+        if (digit >= base) {
+          throw std::invalid_argument("_sl literal must be an integer literal");
+        }
+        n256plus carry = digit;
+        for (size_t i = 0; i < parsed.count; i++) {
+          n256plus value = parsed.limbs[i] * base + carry;
+          parsed.limbs[i] = static_cast<n256>(value & 0xFF);
+          carry = value >> 8;
+        }
+        if (carry > 0) {
+          parsed.limbs[parsed.count++] = static_cast<n256>(carry);
+        }
+      }
+      return parsed;
+    }
+
+  }
+
+  // Numeric form (12345678901234567890_sl): the literal is parsed into limbs
+  // at compile time and only copied into the result at run time
+  template <char... Chars>
+  SuperLong operator"" _sl() {
+    // Four bits per character bounds every supported radix
+    constexpr size_t kMaxLimbs = sizeof...(Chars) / 2 + 1;
+    static constexpr literal::ParsedLimbs<kMaxLimbs> kParsed = literal::parse<kMaxLimbs, Chars...>();
+    return SuperLong {Sign::Positive, kParsed.limbs.data(), kParsed.count};
+  }
+
+  // Non-throwing parse in the style of std::from_chars. On failure returns
+  // std::errc::invalid_argument with ptr == first and leaves value untouched
+  std::from_chars_result from_chars(const char* first, const char* last, SuperLong& value);
+
+  std::ostream& operator<<(std::ostream& os, const SuperLong& value);
+  std::istream& operator>>(std::istream& is, SuperLong& value);
+
+  void writeDecimalFile(const std::string& path, const SuperLong& value);
+  SuperLong readDecimalFile(const std::string& path);
+
+  SuperLong isqrt(const SuperLong& n);
+  SuperLong iroot(const SuperLong& n, uint64_t k);
+  bool is_perfect_square(const SuperLong& n);
+
+  SuperLong gcd(const SuperLong& a, const SuperLong& b);
+  // Returns {g, x, y} with a * x + b * y = g = gcd(a, b)
+  std::tuple<SuperLong, SuperLong, SuperLong> xgcd(const SuperLong& a, const SuperLong& b);
+  // Inverse of a modulo m in [0, m); throws std::invalid_argument if gcd(a, m) != 1
+  SuperLong modinv(const SuperLong& a, const SuperLong& m);
+
+  // a / b when b is known to divide a, computed from the low end without a
+  // remainder. The result is unspecified otherwise; builds with -DDEBUG
+  // check exactness and throw std::logic_error
+  SuperLong divexact(const SuperLong& a, const SuperLong& b);
+
+  // Baillie-PSW: trial division by the primes below 1024, then a base-2
+  // Miller-Rabin round and a strong Lucas test, plus `rounds` further
+  // Miller-Rabin rounds to the bases 3, 5, 7, ... No composite is known to
+  // pass even with rounds = 0
+  bool is_probable_prime(const SuperLong& n, int rounds = 0);
+  // Smallest probable prime greater than n
+  SuperLong next_prime(const SuperLong& n);
+
+  // Balanced product trees: operands meet at similar sizes, so the large
+  // multiplies land in the Karatsuba range instead of scaling by small words
+  SuperLong product(const SuperLong* values, size_t count);
+  SuperLong product(const std::vector<SuperLong>& values);
+  SuperLong factorial(uint64_t n);
+  SuperLong binomial(uint64_t n, uint64_t k);
+  SuperLong primorial(uint64_t n);
+
+}
+
+namespace std {
+
+  template <>
+  struct hash<aoi::SuperLong> {
+    size_t operator()(const aoi::SuperLong& value) const noexcept {
+      return value.hash();
+    }
+  };
+
 }
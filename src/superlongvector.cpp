@@ -0,0 +1,305 @@
+#include "superlongvector.hpp"
+#include "superlong-trace.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <stdexcept>
+
+using namespace aoi;
+
+static constexpr size_t kByteBits = 8;
+static constexpr n256plus kByteMask = 0xFF;
+// Above this many limbs in both factors, element products go through
+// SuperLong so that they reach Karatsuba
+static constexpr size_t kSchoolbookLimbs = 32;
+
+static thread_local std::vector<n256> scratch;
+
+static int compareMagnitudes(const n256* a, size_t na, const n256* b, size_t nb) {
+  if (na != nb) {
+    return (na < nb) ? -1 : 1;
+  }
+  for (size_t i = na; i-- > 0;) {
+    if (a[i] != b[i]) {
+      return (a[i] < b[i]) ? -1 : 1;
+    }
+  }
+  return 0;
+}
+
+static void trimLeadingZeros(std::vector<n256>& out) {
+  while (out.size() > 1 && out.back() == 0) {
+    out.pop_back();
+  }
+}
+
+static void addMagnitudes(const n256* a, size_t na, const n256* b, size_t nb, std::vector<n256>& out) {
+  if (na < nb) {
+    std::swap(a, b);
+    std::swap(na, nb);
+  }
+  out.resize(na + 1);
+  n256plus carry = 0;
+  for (size_t i = 0; i < na; i++) {
+    n256plus sum = a[i] + ((i < nb) ? b[i] : 0) + carry;
+    out[i] = static_cast<n256>(sum & kByteMask);
+    carry = sum >> kByteBits;
+  }
+  out[na] = static_cast<n256>(carry);
+  trimLeadingZeros(out);
+}
+
+// Requires |a| >= |b|
+static void subtractMagnitudes(const n256* a, size_t na, const n256* b, size_t nb, std::vector<n256>& out) {
+  out.resize(na);
+  n256plus borrow = 0;
+  for (size_t i = 0; i < na; i++) {
+    n256plus sub = ((i < nb) ? b[i] : 0) + borrow;
+    borrow = (a[i] < sub) ? 1 : 0;
+    out[i] = static_cast<n256>(a[i] + (borrow << kByteBits) - sub);
+  }
+  trimLeadingZeros(out);
+}
+
+static void multiplyMagnitudes(const n256* a, size_t na, const n256* b, size_t nb, std::vector<n256>& out) {
+  out.assign(na + nb, 0);
+  for (size_t i = 0; i < na; i++) {
+    n256plus carry = 0;
+    for (size_t j = 0; j < nb; j++) {
+      n256plus product = a[i] * b[j] + out[i + j] + carry;
+      out[i + j] = static_cast<n256>(product & kByteMask);
+      carry = product >> kByteBits;
+    }
+    out[i + nb] = static_cast<n256>(carry);
+  }
+  trimLeadingZeros(out);
+}
+
+static bool isZeroMagnitude(const std::vector<n256>& limbs) {
+  return limbs.size() == 1 && limbs[0] == 0;
+}
+
+size_t SuperLongVector::size() const {
+  return offsets.size();
+}
+
+bool SuperLongVector::empty() const {
+  return offsets.empty();
+}
+
+size_t SuperLongVector::limbCount() const {
+  return arena.size() - unused;
+}
+
+void SuperLongVector::reserve(size_t values, size_t limbs) {
+  arena.reserve(limbs);
+  offsets.reserve(values);
+  lengths.reserve(values);
+  signs.reserve(values);
+}
+
+void SuperLongVector::clear() {
+  arena.clear();
+  offsets.clear();
+  lengths.clear();
+  signs.clear();
+  unused = 0;
+}
+
+void SuperLongVector::append(const SuperLong& value) {
+  append(SuperLongView {value.sign, value.digits.data(), value.digits.size()});
+}
+
+void SuperLongVector::append(const SuperLongView& value) {
+  offsets.push_back(appendLimbs(value.limbs(), value.size()));
+  lengths.push_back(static_cast<uint32_t>(value.size()));
+  signs.push_back(value.isNegative() ? Sign::Negative : Sign::Positive);
+}
+
+SuperLongView SuperLongVector::operator[](size_t index) const {
+  return SuperLongView {signs[index], arena.data() + offsets[index], lengths[index]};
+}
+
+SuperLongView SuperLongVector::at(size_t index) const {
+  if (index >= size()) {
+    throw std::out_of_range("SuperLongVector index out of range");
+  }
+  return (*this)[index];
+}
+
+void SuperLongVector::set(size_t index, const SuperLong& value) {
+  if (index >= size()) {
+    throw std::out_of_range("SuperLongVector index out of range");
+  }
+  store(index, value.sign, value.digits.data(), value.digits.size());
+  compactIfSparse();
+}
+
+void SuperLongVector::add(const SuperLongVector& other) {
+  checkSize(other);
+  addElements(&other, SuperLongView {Sign::Positive, nullptr, 0}, false);
+}
+
+void SuperLongVector::subtract(const SuperLongVector& other) {
+  checkSize(other);
+  addElements(&other, SuperLongView {Sign::Positive, nullptr, 0}, true);
+}
+
+void SuperLongVector::multiply(const SuperLongVector& other) {
+  detail::UntracedScope untraced;
+  checkSize(other);
+  multiplyElements(&other, SuperLongView {Sign::Positive, nullptr, 0});
+}
+
+void SuperLongVector::add(const SuperLong& value) {
+  addElements(nullptr, SuperLongView {value.sign, value.digits.data(), value.digits.size()}, false);
+}
+
+void SuperLongVector::subtract(const SuperLong& value) {
+  addElements(nullptr, SuperLongView {value.sign, value.digits.data(), value.digits.size()}, true);
+}
+
+void SuperLongVector::multiply(const SuperLong& value) {
+  detail::UntracedScope untraced;
+  multiplyElements(nullptr, SuperLongView {value.sign, value.digits.data(), value.digits.size()});
+}
+
+void SuperLongVector::negate() {
+  for (size_t i = 0; i < size(); i++) {
+    bool zero = lengths[i] == 1 && arena[offsets[i]] == 0;
+    if (!zero) {
+      signs[i] = (signs[i] == Sign::Negative) ? Sign::Positive : Sign::Negative;
+    }
+  }
+}
+
+int SuperLongVector::compare(size_t i, size_t j) const {
+  return (*this)[i].compare((*this)[j]);
+}
+
+void SuperLongVector::sort() {
+  std::vector<size_t> order(size());
+  std::iota(order.begin(), order.end(), size_t {0});
+  std::sort(order.begin(), order.end(), [this](size_t i, size_t j) { return compare(i, j) < 0; });
+  rebuild(order);
+}
+
+void SuperLongVector::compact() {
+  std::vector<size_t> order(size());
+  std::iota(order.begin(), order.end(), size_t {0});
+  rebuild(order);
+}
+
+bool SuperLongVector::operator==(const SuperLongVector& other) const {
+  if (size() != other.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < size(); i++) {
+    if ((*this)[i].compare(other[i]) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool SuperLongVector::operator!=(const SuperLongVector& other) const {
+  return !(*this == other);
+}
+
+// The source may lie inside the arena itself, so it is located by offset
+// rather than by a pointer that growing the arena would invalidate
+uint64_t SuperLongVector::appendLimbs(const n256* limbs, size_t count) {
+  if (count > UINT32_MAX) {
+    throw std::length_error("Value is too large for SuperLongVector");
+  }
+  uint64_t offset = arena.size();
+  bool inside = !arena.empty() && limbs >= arena.data() && limbs < arena.data() + arena.size();
+  size_t source = inside ? static_cast<size_t>(limbs - arena.data()) : 0;
+  arena.resize(offset + count);
+  std::memcpy(arena.data() + offset, inside ? arena.data() + source : limbs, count);
+  return offset;
+}
+
+void SuperLongVector::store(size_t index, Sign sign, const n256* limbs, size_t count) {
+  if (count <= lengths[index]) {
+    std::memmove(arena.data() + offsets[index], limbs, count);
+    unused += lengths[index] - count;
+  } else {
+    unused += lengths[index];
+    offsets[index] = appendLimbs(limbs, count);
+  }
+  lengths[index] = static_cast<uint32_t>(count);
+  signs[index] = sign;
+}
+
+void SuperLongVector::addElements(const SuperLongVector* other, const SuperLongView& value, bool negateOperand) {
+  for (size_t i = 0; i < size(); i++) {
+    SuperLongView a = (*this)[i];
+    SuperLongView b = (other != nullptr) ? (*other)[i] : value;
+    bool aNegative = a.isNegative();
+    bool bNegative = b.isNegative() != negateOperand;
+    Sign sign;
+    if (aNegative == bNegative) {
+      addMagnitudes(a.limbs(), a.size(), b.limbs(), b.size(), scratch);
+      sign = aNegative ? Sign::Negative : Sign::Positive;
+    } else if (compareMagnitudes(a.limbs(), a.size(), b.limbs(), b.size()) >= 0) {
+      subtractMagnitudes(a.limbs(), a.size(), b.limbs(), b.size(), scratch);
+      sign = aNegative ? Sign::Negative : Sign::Positive;
+    } else {
+      subtractMagnitudes(b.limbs(), b.size(), a.limbs(), a.size(), scratch);
+      sign = bNegative ? Sign::Negative : Sign::Positive;
+    }
+    store(i, isZeroMagnitude(scratch) ? Sign::Positive : sign, scratch.data(), scratch.size());
+  }
+  compactIfSparse();
+}
+
+void SuperLongVector::multiplyElements(const SuperLongVector* other, const SuperLongView& value) {
+  for (size_t i = 0; i < size(); i++) {
+    SuperLongView a = (*this)[i];
+    SuperLongView b = (other != nullptr) ? (*other)[i] : value;
+    Sign sign = (a.isNegative() != b.isNegative()) ? Sign::Negative : Sign::Positive;
+    if (a.size() <= kSchoolbookLimbs || b.size() <= kSchoolbookLimbs) {
+      multiplyMagnitudes(a.limbs(), a.size(), b.limbs(), b.size(), scratch);
+      store(i, isZeroMagnitude(scratch) ? Sign::Positive : sign, scratch.data(), scratch.size());
+    } else {
+      SuperLong product = SuperLong::multiply(a.toSuperLong(), b.toSuperLong());
+      store(i, product.sign, product.digits.data(), product.digits.size());
+    }
+  }
+  compactIfSparse();
+}
+
+void SuperLongVector::checkSize(const SuperLongVector& other) const {
+  if (size() != other.size()) {
+    throw std::invalid_argument("SuperLongVector sizes differ");
+  }
+}
+
+void SuperLongVector::compactIfSparse() {
+  if (unused > arena.size() / 2) {
+    compact();
+  }
+}
+
+void SuperLongVector::rebuild(const std::vector<size_t>& order) {
+  std::vector<n256> packed;
+  packed.reserve(limbCount());
+  std::vector<uint64_t> newOffsets(order.size());
+  std::vector<uint32_t> newLengths(order.size());
+  std::vector<Sign> newSigns(order.size());
+  for (size_t k = 0; k < order.size(); k++) {
+    size_t i = order[k];
+    newOffsets[k] = packed.size();
+    newLengths[k] = lengths[i];
+    newSigns[k] = signs[i];
+    packed.insert(packed.end(), arena.begin() + static_cast<std::ptrdiff_t>(offsets[i]),
+                  arena.begin() + static_cast<std::ptrdiff_t>(offsets[i] + lengths[i]));
+  }
+  arena.swap(packed);
+  offsets.swap(newOffsets);
+  lengths.swap(newLengths);
+  signs.swap(newSigns);
+  unused = 0;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "superlong.hpp"
+
+namespace aoi {
+
+  // A sequence of integers stored column-wise: the limbs of every element
+  // back to back in one arena, plus parallel offset, length and sign
+  // columns. Elements are read through SuperLongView, which stays valid only
+  // until the next call that changes the vector. Results that no longer fit
+  // their slot move to the end of the arena; the space they leave is
+  // reclaimed by compact(), which runs on its own once half the arena is
+  // unused
+  class SuperLongVector {
+   public:
+    SuperLongVector() = default;
+
+    size_t size() const;
+    bool empty() const;
+    // Limbs held by live elements, excluding reclaimable space
+    size_t limbCount() const;
+    void reserve(size_t values, size_t limbs);
+    void clear();
+
+    void append(const SuperLong& value);
+    void append(const SuperLongView& value);
+
+    SuperLongView operator[](size_t index) const;
+    SuperLongView at(size_t index) const;
+    void set(size_t index, const SuperLong& value);
+
+    // Element-wise, in place; vector operands must have the same size
+    void add(const SuperLongVector& other);
+    void subtract(const SuperLongVector& other);
+    void multiply(const SuperLongVector& other);
+    void add(const SuperLong& value);
+    void subtract(const SuperLong& value);
+    void multiply(const SuperLong& value);
+    void negate();
+
+    // Compares two elements in place, returning -1, 0 or 1
+    int compare(size_t i, size_t j) const;
+    // Sorts ascending and rewrites the arena in the new order
+    void sort();
+    void compact();
+
+    bool operator==(const SuperLongVector& other) const;
+    bool operator!=(const SuperLongVector& other) const;
+
+   private:
+    std::vector<n256> arena;
+    std::vector<uint64_t> offsets;
+    std::vector<uint32_t> lengths;
+    std::vector<Sign> signs;
+    size_t unused = 0;
+
+    uint64_t appendLimbs(const n256* limbs, size_t count);
+    void store(size_t index, Sign sign, const n256* limbs, size_t count);
+    // The operand of element i is (*other)[i] when other is set, else value
+    void addElements(const SuperLongVector* other, const SuperLongView& value, bool negateOperand);
+    void multiplyElements(const SuperLongVector* other, const SuperLongView& value);
+    void checkSize(const SuperLongVector& other) const;
+    void compactIfSparse();
+    void rebuild(const std::vector<size_t>& order);
+  };
+
+}
@@ -0,0 +1,255 @@
+#include "superrational.hpp"
+#include "superlong-trace.hpp"
+
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <utility>
+
+using namespace aoi;
+
+SuperRational::SuperRational() : num(), den(1), normalized(true) {
+}
+
+SuperRational::SuperRational(int64_t num) : num(num), den(1), normalized(true) {
+}
+
+SuperRational::SuperRational(const SuperLong& num) : num(num), den(1), normalized(true) {
+}
+
+SuperRational::SuperRational(const SuperLong& num, const SuperLong& den) : num(num), den(den), normalized(false) {
+  if (den.isZero()) {
+    throw std::invalid_argument("Denominator cannot be zero");
+  }
+  if (den.isNegative()) {
+    this->num.negate();
+    this->den.negate();
+  }
+  normalized = (this->den == SuperLong {1});
+}
+
+SuperRational::SuperRational(std::string_view str) : SuperRational() {
+  size_t slash = str.find('/');
+  if (slash == std::string_view::npos) {
+    num = SuperLong {str};
+    return;
+  }
+  *this = SuperRational {SuperLong {str.substr(0, slash)}, SuperLong {str.substr(slash + 1)}};
+}
+
+SuperRational::SuperRational(SuperLong num, SuperLong den, bool normalized)
+    : num(std::move(num)), den(std::move(den)), normalized(normalized) {
+}
+
+SuperRational::SuperRational(Parts parts)
+    : num(std::move(parts.num)), den(std::move(parts.den)), normalized(parts.normalized) {
+}
+
+SuperRational::SuperRational(const SuperRational& other) : SuperRational(other.parts()) {
+}
+
+SuperRational::SuperRational(SuperRational&& other) noexcept
+    : num(std::move(other.num)), den(std::move(other.den)), normalized(other.normalized) {
+}
+
+SuperRational& SuperRational::operator=(const SuperRational& other) {
+  if (this != &other) {
+    Parts source = other.parts();
+    num = std::move(source.num);
+    den = std::move(source.den);
+    normalized = source.normalized;
+  }
+  return *this;
+}
+
+SuperRational& SuperRational::operator=(SuperRational&& other) noexcept {
+  num = std::move(other.num);
+  den = std::move(other.den);
+  normalized = other.normalized;
+  return *this;
+}
+
+SuperRational::Parts SuperRational::parts() const {
+  std::lock_guard<std::mutex> guard(lock);
+  return Parts {num, den, normalized};
+}
+
+SuperRational SuperRational::operator+(const SuperRational& other) const {
+  detail::UntracedScope untraced;
+  Parts a = parts();
+  Parts b = other.parts();
+  if (a.den == b.den) {
+    bool integral = (a.den == SuperLong {1});
+    return SuperRational {a.num + b.num, a.den, integral};
+  }
+  return SuperRational {a.num * b.den + b.num * a.den, a.den * b.den, false};
+}
+
+SuperRational SuperRational::operator-(const SuperRational& other) const {
+  return *this + (-other);
+}
+
+SuperRational SuperRational::operator*(const SuperRational& other) const {
+  detail::UntracedScope untraced;
+  Parts a = parts();
+  Parts b = other.parts();
+  return multiply(a.num, a.den, b.num, b.den, a.normalized && b.normalized);
+}
+
+SuperRational SuperRational::operator/(const SuperRational& other) const {
+  detail::UntracedScope untraced;
+  Parts a = parts();
+  Parts b = other.parts();
+  if (b.num.isZero()) {
+    throw std::invalid_argument("Division by zero");
+  }
+  if (b.num.isNegative()) {
+    return multiply(a.num, a.den, -b.den, -b.num, a.normalized && b.normalized);
+  }
+  return multiply(a.num, a.den, b.den, b.num, a.normalized && b.normalized);
+}
+
+SuperRational SuperRational::operator-() const {
+  detail::UntracedScope untraced;
+  Parts a = parts();
+  return SuperRational {-a.num, a.den, a.normalized};
+}
+
+SuperRational& SuperRational::operator+=(const SuperRational& other) {
+  return *this = *this + other;
+}
+
+SuperRational& SuperRational::operator-=(const SuperRational& other) {
+  return *this = *this - other;
+}
+
+SuperRational& SuperRational::operator*=(const SuperRational& other) {
+  return *this = *this * other;
+}
+
+SuperRational& SuperRational::operator/=(const SuperRational& other) {
+  return *this = *this / other;
+}
+
+bool SuperRational::operator==(const SuperRational& other) const {
+  Parts a = parts();
+  Parts b = other.parts();
+  if (a.normalized && b.normalized) {
+    return a.num == b.num && a.den == b.den;
+  }
+  return compare(a, b) == 0;
+}
+
+bool SuperRational::operator!=(const SuperRational& other) const {
+  return !(*this == other);
+}
+
+bool SuperRational::operator<(const SuperRational& other) const {
+  return compare(parts(), other.parts()) < 0;
+}
+
+bool SuperRational::operator<=(const SuperRational& other) const {
+  return compare(parts(), other.parts()) <= 0;
+}
+
+bool SuperRational::operator>(const SuperRational& other) const {
+  return compare(parts(), other.parts()) > 0;
+}
+
+bool SuperRational::operator>=(const SuperRational& other) const {
+  return compare(parts(), other.parts()) >= 0;
+}
+
+// Once normalized, the fields never change again through const members, so
+// the references numerator() and denominator() hand out stay valid unlocked
+void SuperRational::normalize() const {
+  detail::UntracedScope untraced;
+  std::lock_guard<std::mutex> guard(lock);
+  if (normalized) {
+    return;
+  }
+  if (num.isZero()) {
+    den = SuperLong {1};
+  } else {
+    SuperLong g = gcd(num, den);
+    if (g != SuperLong {1}) {
+      num = divexact(num, g);
+      den = divexact(den, g);
+    }
+  }
+  normalized = true;
+}
+
+bool SuperRational::isNormalized() const {
+  std::lock_guard<std::mutex> guard(lock);
+  return normalized;
+}
+
+bool SuperRational::isZero() const {
+  std::lock_guard<std::mutex> guard(lock);
+  return num.isZero();
+}
+
+bool SuperRational::isNegative() const {
+  std::lock_guard<std::mutex> guard(lock);
+  return num.isNegative();
+}
+
+bool SuperRational::isInteger() const {
+  normalize();
+  return den == SuperLong {1};
+}
+
+const SuperLong& SuperRational::numerator() const {
+  normalize();
+  return num;
+}
+
+const SuperLong& SuperRational::denominator() const {
+  normalize();
+  return den;
+}
+
+std::string SuperRational::toString() const {
+  detail::UntracedScope untraced;
+  normalize();
+  if (den == SuperLong {1}) {
+    return num.toString();
+  }
+  return num.toString() + "/" + den.toString();
+}
+
+// Cross-multiplication never needs a GCD; equal denominators skip it too
+int SuperRational::compare(const Parts& a, const Parts& b) {
+  detail::UntracedScope untraced;
+  if (a.num.isNegative() != b.num.isNegative()) {
+    return a.num.isNegative() ? -1 : 1;
+  }
+  SuperLong left = (a.den == b.den) ? a.num : a.num * b.den;
+  SuperLong right = (a.den == b.den) ? b.num : b.num * a.den;
+  if (left == right) {
+    return 0;
+  }
+  return (left < right) ? -1 : 1;
+}
+
+// (a / b) * (c / d) with b, d > 0. Cancelling the smaller cross pairs a, d
+// and c, b first always keeps the product small. When both fractions are in
+// lowest terms, any common factor of the product lies in one of those pairs,
+// so the result is normalized too
+SuperRational SuperRational::multiply(const SuperLong& a, const SuperLong& b, const SuperLong& c, const SuperLong& d,
+                                      bool normalized) {
+  if (a.isZero() || c.isZero()) {
+    return SuperRational {};
+  }
+  SuperLong g1 = gcd(a, d);
+  SuperLong g2 = gcd(c, b);
+  SuperLong one {1};
+  SuperLong resultNum = ((g1 == one) ? a : divexact(a, g1)) * ((g2 == one) ? c : divexact(c, g2));
+  SuperLong resultDen = ((g2 == one) ? b : divexact(b, g2)) * ((g1 == one) ? d : divexact(d, g1));
+  return SuperRational {std::move(resultNum), std::move(resultDen), normalized};
+}
+
+std::ostream& aoi::operator<<(std::ostream& os, const SuperRational& value) {
+  return os << value.toString();
+}
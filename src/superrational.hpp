@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "superlong.hpp"
+
+namespace aoi {
+
+  // Exact fraction with a positive denominator. Sums and differences are not
+  // reduced; the GCD is taken only by normalize() or when the parts are read
+  // back (numerator(), denominator(), toString()). Products and quotients
+  // always cross-cancel first, and come out normalized when both operands
+  // were. Normalizing in place is guarded by a per-value lock, so a value may
+  // be shared by threads that only use its const members
+  class SuperRational {
+   public:
+    SuperRational();
+    SuperRational(int64_t num);
+    SuperRational(const SuperLong& num);
+    SuperRational(const SuperLong& num, const SuperLong& den);
+    SuperRational(std::string_view str);
+    // Takes std::string ahead of its implicit conversion to SuperLong
+    template <typename Text,
+              std::enable_if_t<std::is_convertible_v<const Text&, std::string_view> &&
+                                   !std::is_convertible_v<const Text&, const char*>,
+                               int> = 0>
+    SuperRational(const Text& str) : SuperRational(std::string_view {str}) {
+    }
+    SuperRational(const SuperRational& other);
+    SuperRational(SuperRational&& other) noexcept;
+    ~SuperRational() = default;
+
+    SuperRational& operator=(const SuperRational& other);
+    SuperRational& operator=(SuperRational&& other) noexcept;
+
+    SuperRational operator+(const SuperRational& other) const;
+    SuperRational operator-(const SuperRational& other) const;
+    SuperRational operator*(const SuperRational& other) const;
+    SuperRational operator/(const SuperRational& other) const;
+    SuperRational operator-() const;
+    SuperRational& operator+=(const SuperRational& other);
+    SuperRational& operator-=(const SuperRational& other);
+    SuperRational& operator*=(const SuperRational& other);
+    SuperRational& operator/=(const SuperRational& other);
+
+    bool operator==(const SuperRational& other) const;
+    bool operator!=(const SuperRational& other) const;
+    bool operator<(const SuperRational& other) const;
+    bool operator<=(const SuperRational& other) const;
+    bool operator>(const SuperRational& other) const;
+    bool operator>=(const SuperRational& other) const;
+
+    void normalize() const;
+    bool isNormalized() const;
+
+    bool isZero() const;
+    bool isNegative() const;
+    bool isInteger() const;
+
+    const SuperLong& numerator() const;
+    const SuperLong& denominator() const;
+
+    // "num/den" in lowest terms, or just "num" when the denominator is 1
+    std::string toString() const;
+
+   private:
+    // A consistent copy of the fields; the limbs themselves are shared
+    struct Parts {
+      SuperLong num;
+      SuperLong den;
+      bool normalized;
+    };
+
+    mutable SuperLong num;
+    mutable SuperLong den;
+    mutable bool normalized;
+    // Held while normalize() rewrites the fields and while other const
+    // members read them
+    mutable std::mutex lock;
+
+    SuperRational(SuperLong num, SuperLong den, bool normalized);
+    explicit SuperRational(Parts parts);
+
+    Parts parts() const;
+
+    static int compare(const Parts& a, const Parts& b);
+    static SuperRational multiply(const SuperLong& a, const SuperLong& b, const SuperLong& c, const SuperLong& d,
+                                  bool normalized);
+  };
+
+  std::ostream& operator<<(std::ostream& os, const SuperRational& value);
+
+}
@@ -1,7 +1,33 @@
 #include "superlong.hpp"
+#include "fixedsuperlong.hpp"
+#include "superlong-async.hpp"
+#include "superlong-mapped.hpp"
+#include "superrational.hpp"
+#include "superfloat.hpp"
+#include "residuesuperlong.hpp"
+#include "superlong-trace.hpp"
+#include "montgomery.hpp"
+#include "superlong-random.hpp"
+#include "superlongvector.hpp"
+#include "decimalsuperlong.hpp"
+#include "montgomerybatch.hpp"
+#include <atomic>
 #include <cassert>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <future>
 #include <iostream>
+#include <iterator>
+#include <random>
+#include <sstream>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 using namespace aoi;
 
@@ -211,6 +237,27 @@ void testMultiplication() {
   SuperLong huge2 {"987654321"};
   TEST("Large multiplication", (huge1 * huge2).toString() == "121932631112635269");
 
+  // Operands past the Karatsuba threshold
+  SuperLong nines {std::string(100, '9')};
+  TEST("Karatsuba-sized square", (nines * nines).toString() == std::string(99, '9') + "8" + std::string(99, '0') + "1");
+
+  // Unbalanced operands: block chopping from a 2:1 size ratio, Toom-3/2 from 3:2
+  SuperLong chopped = ((SuperLong {1} << 20000) - 1LL) * ((SuperLong {1} << 700) + 1LL);
+  TEST("Unbalanced (2^20000 - 1)(2^700 + 1)",
+       chopped == (SuperLong {1} << 20700) + (SuperLong {1} << 20000) - (SuperLong {1} << 700) - 1LL);
+  SuperLong toom = ((SuperLong {1} << 3000) - 1LL) * ((SuperLong {1} << 1800) + 1LL);
+  TEST("Toom-3/2 (2^3000 - 1)(2^1800 + 1)",
+       toom == (SuperLong {1} << 4800) + (SuperLong {1} << 3000) - (SuperLong {1} << 1800) - 1LL);
+  std::mt19937_64 rng {48};
+  bool unbalancedExact = true;
+  for (size_t longBits : {3000, 3500, 5000, 40000}) {
+    SuperLong x = random_bits(longBits, rng) + 1LL;
+    SuperLong y = SuperLong {0} - (random_bits(2000, rng) + 1LL);
+    SuperLong product = x * y;
+    unbalancedExact = unbalancedExact && divexact(product, y) == x && divexact(product, x) == y && y * x == product;
+  }
+  TEST("Unbalanced products divide back exactly", unbalancedExact);
+
   // Using int64_t
   TEST("SuperLong * int64_t", (a * 4LL).toString() == "48");
 }
@@ -246,6 +293,29 @@ void testDivision() {
   SuperLong big2 {"999"};
   TEST("999999999 / 999 = 1001001", (big1 / big2).toString() == "1001001");
 
+  // Multi-limb divisor
+  SuperLong divisor {std::string(60, '7')};
+  SuperLong dividend = divisor * SuperLong {std::string(80, '3')} + SuperLong {"12345"};
+  TEST("Multi-limb division", (dividend / divisor).toString() == std::string(80, '3') && (dividend % divisor).toString() == "12345");
+
+  // Sizes that take the Newton reciprocal path
+  std::mt19937_64 rng {26};
+  bool newton = true;
+  for (size_t bits : {1000, 2000, 9000, 40000}) {
+    for (size_t divisorBits : {600, 1500, 5000, 30000}) {
+      SuperLong divisor = random_bits(divisorBits, rng) + SuperLong {1};
+      SuperLong dividend = random_bits(bits + divisorBits, rng) - random_bits(bits, rng);
+      SuperLong q = dividend / divisor;
+      SuperLong r = dividend % divisor;
+      SuperLong magnitude = r.isNegative() ? -r : r;
+      newton = newton && q * divisor + r == dividend && magnitude < divisor &&
+               (r.isZero() || r.isNegative() == dividend.isNegative());
+    }
+  }
+  TEST("Large division satisfies a = q * b + r", newton);
+  SuperLong allOnes = (SuperLong {1} << 8192) - 1LL;
+  TEST("Large division with remainder b - 1", (allOnes * allOnes + allOnes - 1LL) % allOnes == allOnes - 1LL);
+
   // Using int64_t
   TEST("SuperLong / int64_t", (a / 5LL).toString() == "20");
 }
@@ -270,6 +340,7 @@ void testModulo() {
   SuperLong g {"-17"};
   SuperLong h {"5"};
   TEST("-17 % 5 = -2", (g % h).toString() == "-2");
+  TEST("-15 % 5 = 0 without a sign", (SuperLong {-15} % h).toString() == "0" && (SuperLong {-15} % h) == SuperLong {});
 
   // Using int64_t
   TEST("SuperLong % int64_t", (a % 7LL).toString() == "2");
@@ -597,6 +668,1346 @@ void testUserDefinedLiteral() {
 
   TEST("_sl equals constructor result", "987654321"_sl == SuperLong("987654321"));
   TEST("_sl works in arithmetic", ("100"_sl + "23"_sl).toString() == "123");
+
+  TEST("numeric _sl parses beyond 64 bits", (123456789012345678901234567890_sl).toString() == "123456789012345678901234567890");
+  TEST("numeric _sl matches string _sl", 98765432109876543210_sl == "98765432109876543210"_sl);
+  TEST("numeric _sl hex literal", (0xFFFF'FFFF'FFFF'FFFF'FFFF_sl).toString() == "1208925819614629174706175");
+  TEST("numeric _sl binary literal", (0b1010_sl).toString() == "10");
+  TEST("numeric _sl octal literal", (0777_sl).toString() == "511");
+  TEST("numeric _sl digit separators", (1'000'000_sl).toString() == "1000000");
+  TEST("numeric _sl zero", (0_sl).isZero());
+  TEST("unary minus on numeric _sl", (-42_sl).toString() == "-42");
+  TEST("unary minus keeps zero positive", (-(0_sl)).isPositive());
+}
+
+// Integer root tests
+void testRoots() {
+  std::cout << "\n=== Integer Root Tests ===" << std::endl;
+
+  TEST("isqrt(0) = 0", isqrt(SuperLong {}).isZero());
+  TEST("isqrt(1) = 1", isqrt(SuperLong {1}).toString() == "1");
+  TEST("isqrt(99) = 9", isqrt(SuperLong {99}).toString() == "9");
+  TEST("isqrt(100) = 10", isqrt(SuperLong {100}).toString() == "10");
+
+  SuperLong root {"123456789012345678901234567890"};
+  SuperLong square = root * root;
+  TEST("isqrt of large perfect square", isqrt(square) == root);
+  TEST("isqrt of large square minus one", isqrt(square - 1LL) == root - 1LL);
+  TEST("isqrt of large square plus one", isqrt(square + 1LL) == root);
+
+  SuperLong cube = root * root * root;
+  TEST("iroot of large perfect cube", iroot(cube, 3) == root);
+  TEST("iroot of large cube minus one", iroot(cube - 1LL, 3) == root - 1LL);
+  TEST("iroot of negative cube", iroot(SuperLong(0LL) - cube, 3) == SuperLong(0LL) - root);
+  TEST("iroot(2^100, 5) = 2^20", iroot(SuperLong {1} << 100, 5) == (SuperLong {1} << 20));
+  TEST("iroot with degree larger than bit length", iroot(SuperLong {1000}, 20).toString() == "1");
+  TEST("iroot degree one is identity", iroot(root, 1) == root);
+
+  std::mt19937_64 rng {26};
+  SuperLong bigRoot = random_bits(40000, rng);
+  SuperLong bigSquare = bigRoot * bigRoot;
+  TEST("isqrt of a 80000-bit square", isqrt(bigSquare) == bigRoot && isqrt(bigSquare - 1LL) == bigRoot - 1LL);
+  TEST("iroot of a 60000-bit cube", iroot(bigSquare * bigRoot + bigSquare, 3) == bigRoot);
+  TEST("is_perfect_square(2^600)", is_perfect_square(SuperLong {1} << 600));
+
+  TEST("is_perfect_square(0)", is_perfect_square(SuperLong {}));
+  TEST("is_perfect_square(144)", is_perfect_square(SuperLong {144}));
+  TEST("NOT is_perfect_square(145)", !is_perfect_square(SuperLong {145}));
+  TEST("is_perfect_square of large square", is_perfect_square(square));
+  TEST("NOT is_perfect_square of large square plus one", !is_perfect_square(square + 1LL));
+  TEST("NOT is_perfect_square of negative", !is_perfect_square(SuperLong {-4}));
+
+  try {
+    isqrt(SuperLong {-4});
+    TEST("isqrt of negative throws exception", false);
+  } catch (const std::invalid_argument&) {
+    TEST("isqrt of negative throws exception", true);
+  }
+
+  try {
+    iroot(SuperLong {8}, 0);
+    TEST("iroot of degree zero throws exception", false);
+  } catch (const std::invalid_argument&) {
+    TEST("iroot of degree zero throws exception", true);
+  }
+}
+
+// GCD tests
+void testGcd() {
+  std::cout << "\n=== GCD Tests ===" << std::endl;
+
+  TEST("gcd(12, 18) = 6", gcd(SuperLong {12}, SuperLong {18}).toString() == "6");
+  TEST("gcd(-12, 18) = 6", gcd(SuperLong {-12}, SuperLong {18}).toString() == "6");
+  TEST("gcd(0, -7) = 7", gcd(SuperLong {}, SuperLong {-7}).toString() == "7");
+  TEST("gcd(0, 0) = 0", gcd(SuperLong {}, SuperLong {}).isZero());
+
+  SuperLong common {"1234567890123456789012345678901"};
+  SuperLong p {"98765432109876543210987654321098765432109876543"};
+  SuperLong q {"11111111111111111111111111111111111111111111113"};
+  SuperLong g = gcd(common * p, common * q);
+  TEST("gcd of large multiples divides both", ((common * p) % g).isZero() && ((common * q) % g).isZero());
+  TEST("gcd of large multiples keeps common factor", (g % common).isZero());
+  TEST("gcd is symmetric", gcd(common * q, common * p) == g);
+
+  SuperLong a {"314159265358979323846264338327950288419716939937510"};
+  SuperLong b {"-271828182845904523536028747135266249775724709369995"};
+  auto [d, x, y] = xgcd(a, b);
+  TEST("xgcd matches gcd", d == gcd(a, b));
+  TEST("xgcd Bezout identity", a * x + b * y == d);
+
+  auto [d2, x2, y2] = xgcd(common * p, common * q);
+  TEST("xgcd Bezout identity with common factor", (common * p) * x2 + (common * q) * y2 == d2);
+
+  SuperLong m {"340282366920938463463374607431768211507"};
+  SuperLong inv = modinv(a, m);
+  TEST("modinv is in range", !inv.isNegative() && inv < m);
+  TEST("modinv inverts value", (a * inv) % m == SuperLong {1});
+  SuperLong negA = SuperLong(0LL) - a;
+  TEST("modinv of negative value", ((negA * modinv(negA, m)) % m + m) % m == SuperLong {1});
+
+  std::mt19937_64 rng(27);
+  SuperLong bigCommon = random_bits(3000, rng);
+  SuperLong bigA = bigCommon * random_bits(9000, rng);
+  SuperLong bigB = bigCommon * random_bits(7000, rng);
+  auto [bigD, bigX, bigY] = xgcd(bigA, bigB);
+  TEST("Half-GCD xgcd Bezout identity", bigA * bigX + bigB * bigY == bigD);
+  TEST("Half-GCD gcd divides both", (bigA % bigD).isZero() && (bigB % bigD).isZero());
+  TEST("Half-GCD gcd keeps common factor", (bigD % bigCommon).isZero());
+  TEST("Half-GCD gcd matches xgcd", gcd(bigA, bigB) == bigD);
+
+  SuperLong fibPrev {1}, fibCur {1};
+  for (int i = 0; i < 12000; i++) {
+    SuperLong next = fibPrev + fibCur;
+    fibPrev = fibCur;
+    fibCur = next;
+  }
+  auto [fibD, fibX, fibY] = xgcd(fibCur, fibPrev);
+  TEST("Half-GCD of consecutive Fibonacci numbers is 1", fibD == SuperLong {1} && gcd(fibCur, fibPrev) == SuperLong {1});
+  TEST("Half-GCD Fibonacci Bezout identity", fibCur * fibX + fibPrev * fibY == fibD);
+
+  try {
+    modinv(SuperLong {6}, SuperLong {9});
+    TEST("modinv of non-invertible value throws exception", false);
+  } catch (const std::invalid_argument&) {
+    TEST("modinv of non-invertible value throws exception", true);
+  }
+}
+
+// Binary serialization tests
+void testSerialization() {
+  std::cout << "\n=== Serialization Tests ===" << std::endl;
+
+  SuperLong a {"-123456789012345678901234567890"};
+  SuperLong b {"987654321"};
+  SuperLong zero {};
+
+  std::vector<uint8_t> buffer(a.serializedSize() + b.serializedSize() + zero.serializedSize());
+  size_t offset = a.serialize(buffer.data(), buffer.size());
+  offset += b.serialize(buffer.data() + offset, buffer.size() - offset);
+  offset += zero.serialize(buffer.data() + offset, buffer.size() - offset);
+  TEST("serialize fills exact size", offset == buffer.size());
+  TEST("serialize writes sign and limb count", buffer[0] == 1 && buffer[1] == a.serializedSize() - 9);
+
+  size_t consumed = 0;
+  SuperLong back = SuperLong::deserialize(buffer.data(), buffer.size(), &consumed);
+  TEST("deserialize round trip", back == a);
+  TEST("deserialize reports consumed bytes", consumed == a.serializedSize());
+
+  SuperLongArrayView array {buffer.data(), buffer.size()};
+  std::vector<SuperLong> values;
+  for (const SuperLongView& view : array) {
+    values.push_back(view.toSuperLong());
+  }
+  TEST("array view iterates all values", values.size() == 3);
+  TEST("array view values match", values.size() == 3 && values[0] == a && values[1] == b && values[2].isZero());
+  TEST("view compares with SuperLong", *array.begin() == a && *array.begin() != b);
+
+  try {
+    a.serialize(buffer.data(), 4);
+    TEST("serialize into small buffer throws exception", false);
+  } catch (const std::invalid_argument&) {
+    TEST("serialize into small buffer throws exception", true);
+  }
+
+  try {
+    SuperLong::deserialize(buffer.data(), a.serializedSize() - 1);
+    TEST("deserialize truncated input throws exception", false);
+  } catch (const std::invalid_argument&) {
+    TEST("deserialize truncated input throws exception", true);
+  }
+
+  std::vector<uint8_t> negativeZero(zero.serializedSize());
+  zero.serialize(negativeZero.data(), negativeZero.size());
+  negativeZero[0] = 1;
+  try {
+    SuperLong::deserialize(negativeZero.data(), negativeZero.size());
+    TEST("deserialize negative zero throws exception", false);
+  } catch (const std::invalid_argument&) {
+    TEST("deserialize negative zero throws exception", true);
+  }
+}
+
+// Stream and file I/O tests
+void testStreams() {
+  std::cout << "\n=== Stream I/O Tests ===" << std::endl;
+
+  SuperLong big {"-1000000000000000000000000000000000000000000123456789"};
+  std::ostringstream out;
+  out << big << ' ' << SuperLong {} << ' ' << SuperLong {1000000000};
+  TEST("operator<< writes decimal", out.str() == "-1000000000000000000000000000000000000000000123456789 0 1000000000");
+
+  std::istringstream in {"  +00042 -1000000000000000000000000000000000000000000123456789\n-0 17x"};
+  SuperLong a, b, c, d;
+  in >> a >> b >> c >> d;
+  TEST("operator>> accepts plus sign and leading zeros", a.toString() == "42");
+  TEST("operator>> reads large negative value", b == big);
+  TEST("operator>> normalizes negative zero", c.isZero() && c.isPositive());
+  TEST("operator>> stops at first non-digit", d.toString() == "17" && in.peek() == 'x');
+
+  std::istringstream bad {"- 12"};
+  SuperLong untouched {5};
+  bad >> untouched;
+  TEST("operator>> fails on sign without digits", bad.fail() && untouched.toString() == "5");
+
+  std::istringstream empty {"abc"};
+  empty >> untouched;
+  TEST("operator>> fails on non-digit input", empty.fail());
+
+  std::string path = (std::filesystem::temp_directory_path() / "superlong_stream_test.txt").string();
+  SuperLong huge = (SuperLong {1} << 4000) - 1LL;
+  writeDecimalFile(path, huge);
+  TEST("decimal file round trip", readDecimalFile(path) == huge);
+
+  std::mt19937_64 rng(29);
+  SuperLong multiBlock = SuperLong {0LL} - random_bits(200000, rng);
+  writeDecimalFile(path, multiBlock);
+  TEST("decimal file round trip over many blocks", readDecimalFile(path) == multiBlock);
+  std::filesystem::remove(path);
+
+  std::ostringstream streamed;
+  streamed << multiBlock;
+  TEST("operator<< matches fromString over many blocks", SuperLong::fromString(streamed.str(), 10) == multiBlock);
+
+  std::string blockMultiple = "000" + std::string(9 * 512 * 3 - 4, '0') + "7" + std::string(9 * 512, '9');
+  std::istringstream blocks {blockMultiple};
+  SuperLong fromBlocks;
+  blocks >> fromBlocks;
+  TEST("operator>> joins whole blocks with inner zeros",
+       fromBlocks == SuperLong::fromString(blockMultiple, 10) && blocks.eof());
+
+  try {
+    readDecimalFile(path);
+    TEST("reading missing file throws exception", false);
+  } catch (const std::runtime_error&) {
+    TEST("reading missing file throws exception", true);
+  }
+}
+
+// Radix conversion tests
+void testRadix() {
+  std::cout << "\n=== Radix Conversion Tests ===" << std::endl;
+
+  SuperLong a {"-255"};
+  TEST("toString(16) of negative value", a.toString(16) == "-ff");
+  TEST("toString(2)", SuperLong {10}.toString(2) == "1010");
+  TEST("toString(8)", SuperLong {511}.toString(8) == "777");
+  TEST("toString(32)", SuperLong {1023}.toString(32) == "vv");
+  TEST("toString(36)", SuperLong {35}.toString(36) == "z");
+  TEST("toString(3)", SuperLong {8}.toString(3) == "22");
+  TEST("toString(10) matches toString()", a.toString(10) == a.toString());
+  TEST("toString(7) of zero", SuperLong {}.toString(7) == "0");
+
+  TEST("fromString hex", SuperLong::fromString("-FfFf", 16).toString() == "-65535");
+  TEST("fromString binary", SuperLong::fromString("+1010", 2).toString() == "10");
+  TEST("fromString base 36", SuperLong::fromString("zz", 36).toString() == "1295");
+  TEST("fromString leading zeros", SuperLong::fromString("000777", 8).toString() == "511");
+  TEST("fromString negative zero", SuperLong::fromString("-0", 5).isZero());
+
+  SuperLong big = (SuperLong {"123456789012345678901234567890123456789"} << 3000) + 12345LL;
+  bool roundTrips = true;
+  for (int base = 2; base <= 36; base++) {
+    roundTrips = roundTrips && SuperLong::fromString(big.toString(base), base) == big;
+  }
+  TEST("Large value round trips in every radix", roundTrips);
+  TEST("Large value decimal radix path matches toString()", big.toString(10) == big.toString());
+  TEST("Large value decimal radix parse matches constructor", SuperLong::fromString(big.toString(), 10) == big);
+
+  SuperLong huge = (SuperLong {"987654321987654321"} << 20000) + (SuperLong {1} << 9000) + 7LL;
+  TEST("Huge value decimal radix split matches toString()", huge.toString(10) == huge.toString());
+  TEST("Huge value round trips in radix 7", SuperLong::fromString(huge.toString(7), 7) == huge);
+
+  std::string powerOfTen = "1" + std::string(6000, '0') + "1" + std::string(3000, '0');
+  TEST("Radix split keeps inner zero blocks", SuperLong::fromString(powerOfTen, 10).toString(10) == powerOfTen);
+
+  SuperLong splitPower = SuperLong::fromString("1" + std::string(9 * 512, '0'), 10);
+  TEST("Radix split of an exact split power", (splitPower * splitPower).toString(10) == "1" + std::string(9 * 1024, '0'));
+  TEST("Radix split just below a split power", (splitPower * splitPower - 1LL).toString(10) == std::string(9 * 1024, '9'));
+
+  try {
+    SuperLong::fromString("129", 8);
+    TEST("fromString rejects digit outside radix", false);
+  } catch (const std::invalid_argument&) {
+    TEST("fromString rejects digit outside radix", true);
+  }
+
+  try {
+    SuperLong {1}.toString(37);
+    TEST("toString rejects radix above 36", false);
+  } catch (const std::invalid_argument&) {
+    TEST("toString rejects radix above 36", true);
+  }
+}
+
+// from_chars and string_view parsing tests
+void testFromChars() {
+  std::cout << "\n=== from_chars Tests ===" << std::endl;
+
+  std::string buffer = "12345678901234567890123,-42;+007 x";
+  const char* first = buffer.data();
+  const char* last = buffer.data() + buffer.size();
+
+  SuperLong value;
+  std::from_chars_result result = from_chars(first, last, value);
+  TEST("from_chars parses leading number", result.ec == std::errc {} && value.toString() == "12345678901234567890123");
+  TEST("from_chars stops at first non-digit", result.ptr == first + 23 && *result.ptr == ',');
+
+  result = from_chars(result.ptr + 1, last, value);
+  TEST("from_chars parses negative number", result.ec == std::errc {} && value.toString() == "-42" && *result.ptr == ';');
+
+  result = from_chars(result.ptr + 1, last, value);
+  TEST("from_chars parses plus sign and leading zeros", result.ec == std::errc {} && value.toString() == "7");
+
+  SuperLong untouched {99};
+  const char* space = result.ptr;
+  result = from_chars(space, last, untouched);
+  TEST("from_chars reports error without digits", result.ec == std::errc::invalid_argument && result.ptr == space);
+  TEST("from_chars leaves value untouched on error", untouched.toString() == "99");
+
+  std::string sign = "-x";
+  result = from_chars(sign.data(), sign.data() + sign.size(), untouched);
+  TEST("from_chars rejects sign without digits", result.ec == std::errc::invalid_argument && result.ptr == sign.data());
+
+  std::string zero = "-0000000000000000000";
+  result = from_chars(zero.data(), zero.data() + zero.size(), value);
+  TEST("from_chars normalizes negative zero", result.ec == std::errc {} && value.isZero() && value.isPositive());
+
+  std::string_view view = std::string_view {buffer}.substr(0, 5);
+  TEST("string_view constructor parses view only", SuperLong {view}.toString() == "12345");
+
+  std::string digits = "31415926535897932384626433832795028841971693993751";
+  TEST("long digit runs cross SWAR blocks", SuperLong {digits}.toString() == digits);
+  SuperLong converted = digits;
+  TEST("std::string converts implicitly", converted == SuperLong {digits} && converted + digits == converted * SuperLong {2});
+
+  try {
+    SuperLong bad {std::string_view {"1234567890123456x"}};
+    TEST("string_view constructor rejects trailing characters", false);
+  } catch (const std::invalid_argument&) {
+    TEST("string_view constructor rejects trailing characters", true);
+  }
+}
+
+// Hashing tests
+void testHash() {
+  std::cout << "\n=== Hash Tests ===" << std::endl;
+
+  std::hash<SuperLong> hasher;
+  SuperLong a {"123456789012345678901234567890"};
+  SuperLong b = SuperLong {"123456789012345678901234567889"} + 1LL;
+  TEST("Equal values hash equally", hasher(a) == hasher(b));
+  TEST("Negative zero hashes like zero", hasher(SuperLong {"-0"}) == hasher(SuperLong {}));
+  TEST("Sign changes hash", hasher(a) != hasher(SuperLong(0LL) - a));
+  TEST("Neighbouring values hash differently", hasher(a) != hasher(a + 1LL));
+
+  std::unordered_map<SuperLong, int> cache;
+  for (int i = 0; i < 100; i++) {
+    cache[SuperLong {1} << i] = i;
+  }
+  TEST("unordered_map keyed by SuperLong", cache.size() == 100 && cache[SuperLong {1} << 64] == 64);
+}
+
+// Product tree tests
+void testProducts() {
+  std::cout << "\n=== Product Tree Tests ===" << std::endl;
+
+  TEST("factorial(0) = 1", factorial(0).toString() == "1");
+  TEST("factorial(20)", factorial(20).toString() == "2432902008176640000");
+  TEST("factorial(30)", factorial(30).toString() == "265252859812191058636308480000000");
+
+  SuperLong naive {1};
+  for (int i = 2; i <= 300; i++) {
+    naive *= SuperLong {i};
+  }
+  TEST("factorial(300) matches repeated multiplication", factorial(300) == naive);
+
+  TEST("binomial(10, 3) = 120", binomial(10, 3).toString() == "120");
+  TEST("binomial(5, 7) = 0", binomial(5, 7).isZero());
+  TEST("binomial(100, 50)", binomial(100, 50).toString() == "100891344545564193334812497256");
+  TEST("binomial(300, 120) matches factorials", binomial(300, 120) * factorial(120) * factorial(180) == factorial(300));
+
+  TEST("primorial(1) = 1", primorial(1).toString() == "1");
+  TEST("primorial(30) = 6469693230", primorial(30).toString() == "6469693230");
+
+  std::vector<SuperLong> values {SuperLong {"-12345678901234567890"}, SuperLong {3}, SuperLong {"98765432109876543210"}};
+  TEST("product of list", product(values) == values[0] * values[1] * values[2]);
+  TEST("product of empty list is one", product(std::vector<SuperLong> {}).toString() == "1");
+}
+
+// Accumulator tests
+void testAccumulator() {
+  std::cout << "\n=== Accumulator Tests ===" << std::endl;
+
+  Accumulator empty;
+  TEST("Empty accumulator is zero", empty.value().isZero());
+
+  Accumulator sum;
+  SuperLong expected;
+  for (int i = 0; i < 2000; i++) {
+    SuperLong term = (SuperLong {i * 7919} << (i % 97)) + SuperLong {"123456789012345678901234567890"};
+    if (i % 3 == 0) {
+      term.negate();
+    }
+    sum += term;
+    expected += term;
+  }
+  TEST("Accumulator matches repeated addition", sum.value() == expected);
+
+  sum -= expected;
+  TEST("Accumulator subtract returns to zero", sum.value().isZero());
+
+  Accumulator dot;
+  SuperLong dotExpected;
+  for (int i = 1; i <= 50; i++) {
+    SuperLong x = SuperLong {i} << (i * 5);
+    SuperLong y = SuperLong {"-98765432109876543210"} + SuperLong {i * i};
+    dot.addProduct(x, y);
+    dotExpected += x * y;
+  }
+  SuperLong wide = SuperLong {1} << 600;
+  dot.addProduct(wide - 1LL, wide + 1LL);
+  dotExpected += (wide - 1LL) * (wide + 1LL);
+  TEST("Accumulator dot product", dot.value() == dotExpected);
+
+  dot.reset();
+  TEST("Accumulator reset clears value", dot.value().isZero());
+}
+
+// Fixed-width tests
+void testFixedWidth() {
+  std::cout << "\n=== Fixed-width Tests ===" << std::endl;
+
+  using Fixed256 = FixedSuperLong<256>;
+  using Fixed128 = FixedSuperLong<128>;
+
+  static_assert(Fixed256 {7} * Fixed256 {6} == Fixed256 {42}, "constexpr multiplication");
+  static_assert((Fixed256 {1} << 200) / (Fixed256 {1} << 100) == (Fixed256 {1} << 100), "constexpr division");
+  static_assert(Fixed256 {-17} % Fixed256 {5} == Fixed256 {-2}, "constexpr remainder follows dividend sign");
+  static_assert(Fixed256 {-5} < Fixed256 {3}, "constexpr comparison");
+
+  SuperLong a {"-123456789012345678901234567890123456789"};
+  SuperLong b {"98765432109876543210987654321"};
+  Fixed256 fa {a};
+  Fixed256 fb {b};
+  TEST("FixedSuperLong round trips SuperLong", fa.toSuperLong() == a && fb.toSuperLong() == b);
+  TEST("FixedSuperLong addition", (fa + fb).toSuperLong() == a + b);
+  TEST("FixedSuperLong subtraction", (fb - fa).toSuperLong() == b - a);
+  TEST("FixedSuperLong multiplication", (fa * fb).toSuperLong() == a * b);
+  TEST("FixedSuperLong division", (fa / fb).toSuperLong() == a / b);
+  TEST("FixedSuperLong remainder", (fa % fb).toSuperLong() == a % b);
+  TEST("FixedSuperLong right shift matches SuperLong", (fa >> 37).toSuperLong() == (a >> 37));
+  TEST("FixedSuperLong left shift matches SuperLong", (fb << 29).toSuperLong() == (b << 29));
+  TEST("FixedSuperLong toString", fa.toString() == a.toString());
+  TEST("FixedSuperLong comparison", fa < fb && fb > fa && fa != fb && fa <= fa);
+
+  Fixed128 counter {-1};
+  counter++;
+  TEST("FixedSuperLong increment through zero", counter.isZero() && counter.isPositive());
+  --counter;
+  TEST("FixedSuperLong decrement below zero", counter.isNegative() && counter.toString() == "-1");
+
+  Fixed128 maxValue = (Fixed128 {1} << 127) - Fixed128 {1};
+  TEST("FixedSuperLong wraps on overflow", (maxValue + Fixed128 {1}).toSuperLong() == SuperLong(0LL) - (SuperLong {1} << 127));
+  TEST("FixedSuperLong accepts minimum value", Fixed128 {SuperLong(0LL) - (SuperLong {1} << 127)}.isNegative());
+
+  try {
+    Fixed128 tooBig {SuperLong {1} << 127};
+    TEST("FixedSuperLong rejects out-of-range value", false);
+  } catch (const std::out_of_range&) {
+    TEST("FixedSuperLong rejects out-of-range value", true);
+  }
+
+  try {
+    Fixed128 zero;
+    static_cast<void>(Fixed128 {1} / zero);
+    TEST("FixedSuperLong division by zero throws exception", false);
+  } catch (const std::invalid_argument&) {
+    TEST("FixedSuperLong division by zero throws exception", true);
+  }
+}
+
+void testAsync() {
+  std::cout << "\n=== Async Tests ===" << std::endl;
+
+  SuperLong a = factorial(300);
+  SuperLong b = factorial(200) + SuperLong {7};
+  TEST("multiplyAsync matches multiplication", multiplyAsync(a, b).get() == a * b);
+  TEST("divideAsync matches division", divideAsync(a, b).get() == a / b);
+  TEST("modAsync matches remainder", modAsync(a, b).get() == a % b);
+  TEST("toStringAsync matches toString", toStringAsync(a).get() == a.toString());
+
+  CancellationToken cancelled;
+  cancelled.cancel();
+  std::future<SuperLong> product = multiplyAsync(a, b, cancelled);
+  try {
+    product.get();
+    TEST("Cancelled token throws from get", false);
+  } catch (const OperationCancelled&) {
+    TEST("Cancelled token throws from get", true);
+  }
+
+  CancellationToken expired;
+  expired.setDeadline(CancellationToken::Clock::now() - std::chrono::seconds {1});
+  TEST("Past deadline reports expired", expired.isExpired());
+  std::future<SuperLong> quotient = divideAsync(a * a, b, expired);
+  try {
+    quotient.get();
+    TEST("Expired deadline throws from get", false);
+  } catch (const OperationCancelled&) {
+    TEST("Expired deadline throws from get", true);
+  }
+
+  CancellationToken tracked;
+  std::atomic<int> reports {0};
+  std::atomic<bool> monotonic {true};
+  double last = 0;
+  tracked.setProgressCallback([&](double fraction) {
+    if (fraction < last) {
+      monotonic = false;
+    }
+    last = fraction;
+    reports++;
+  });
+  SuperLong big = factorial(2000);
+  TEST("Progress does not change the result", toStringAsync(big, tracked).get() == big.toString());
+  TEST("Progress callback is invoked", reports > 0);
+  TEST("Progress is monotonic and completes", monotonic && last == 1.0);
+  TEST("Token reflects no cancellation", !tracked.isCancelled() && !tracked.isExpired());
+
+  try {
+    divideAsync(a, SuperLong {}).get();
+    TEST("Async division by zero propagates exception", false);
+  } catch (const std::invalid_argument&) {
+    TEST("Async division by zero propagates exception", true);
+  }
+}
+
+// Out-of-core tests use a tiny resident budget so every operation spans many windows
+void testMapped() {
+  std::cout << "\n=== Mapped Tests ===" << std::endl;
+
+  std::filesystem::path dir = std::filesystem::temp_directory_path();
+  std::string pathA = (dir / "superlong_mapped_a.bin").string();
+  std::string pathB = (dir / "superlong_mapped_b.bin").string();
+  std::string pathC = (dir / "superlong_mapped_c.bin").string();
+  constexpr size_t budget = 4096;
+
+  SuperLong a = (SuperLong {3} << 90000) + factorial(500);
+  SuperLong b = SuperLong(0LL) - ((SuperLong {7} << 70000) - SuperLong {12345});
+
+  {
+    MappedSuperLong ma = MappedSuperLong::create(pathA, a);
+    MappedSuperLong mb = MappedSuperLong::create(pathB, b);
+    TEST("Mapped value round trips", ma.toSuperLong() == a && mb.toSuperLong() == b);
+    TEST("Mapped value reports sign and size", !ma.isNegative() && mb.isNegative() && ma.size() == a.serializedSize() - SuperLong::kSerialHeaderSize);
+
+    MappedSuperLong reopened = MappedSuperLong::open(pathA);
+    TEST("Mapped file reopens", reopened.toSuperLong() == a);
+
+    TEST("Mapped addition", MappedSuperLong::add(ma, mb, pathC, budget).toSuperLong() == a + b);
+    TEST("Mapped addition of like signs", MappedSuperLong::add(ma, ma, pathC, budget).toSuperLong() == a + a);
+    TEST("Mapped subtraction", MappedSuperLong::subtract(mb, ma, pathC, budget).toSuperLong() == b - a);
+    MappedSuperLong zero = MappedSuperLong::subtract(ma, ma, pathC, budget);
+    TEST("Mapped subtraction to zero", zero.isZero() && !zero.isNegative() && zero.toSuperLong() == SuperLong {});
+    TEST("Mapped multiplication", MappedSuperLong::multiply(ma, mb, pathC, budget).toSuperLong() == a * b);
+
+    SuperLong ones = (SuperLong {1} << 40000) - SuperLong {1};
+    MappedSuperLong mOnes = MappedSuperLong::create(pathB, ones);
+    TEST("Mapped multiplication with long carries", MappedSuperLong::multiply(mOnes, mOnes, pathC, budget).toSuperLong() == ones * ones);
+    TEST("Mapped addition with long carries", MappedSuperLong::add(mOnes, MappedSuperLong::create(pathA, SuperLong {1}), pathC, budget).toSuperLong() == ones + SuperLong {1});
+
+    MappedSuperLong product = MappedSuperLong::multiply(mOnes, mOnes, pathC);
+    std::ifstream file(pathC, std::ios::binary);
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    TEST("Mapped file is in serialized format", SuperLong::deserialize(bytes.data(), bytes.size()) == ones * ones);
+
+    MappedSuperLong square = MappedSuperLong::multiply(product, product, pathC, budget);
+    TEST("Mapped result may replace its operand", square.toSuperLong() == (ones * ones) * (ones * ones) && product.toSuperLong() == ones * ones);
+    TEST("Mapped result replaces operand on disk", MappedSuperLong::open(pathC).toSuperLong() == square.toSuperLong());
+    MappedSuperLong sum = MappedSuperLong::add(square, mb, pathC, budget);
+    TEST("Mapped addition may replace its operand", sum.toSuperLong() == (ones * ones) * (ones * ones) + b);
+
+    MappedSuperLong moved = MappedSuperLong::create(pathA, a);
+    moved = MappedSuperLong::create(pathB, b);
+    TEST("Mapped move assignment", moved.toSuperLong() == b && moved.path() == pathB);
+    moved = std::move(sum);
+    TEST("Mapped move assignment over a value", moved.toSuperLong() == (ones * ones) * (ones * ones) + b);
+  }
+
+  try {
+    MappedSuperLong::open((dir / "superlong_mapped_missing.bin").string());
+    TEST("Opening missing mapped file throws exception", false);
+  } catch (const std::runtime_error&) {
+    TEST("Opening missing mapped file throws exception", true);
+  }
+
+  std::filesystem::remove(pathA);
+  std::filesystem::remove(pathB);
+  std::filesystem::remove(pathC);
+}
+
+// Copy-on-write storage tests
+void testCopyOnWrite() {
+  std::cout << "\n=== Copy-on-Write Tests ===" << std::endl;
+
+  LimbBuffer buffer {1, 2, 3};
+  LimbBuffer same {1, 2, 3};
+  LimbBuffer copy {buffer};
+  TEST("LimbBuffer copy shares storage", buffer.isShared() && copy.isShared() && std::as_const(buffer).data() == std::as_const(copy).data());
+  copy[0] = 9;
+  TEST("LimbBuffer write detaches copy", !buffer.isShared() && !copy.isShared() && buffer[0] == 1 && copy[0] == 9);
+  LimbBuffer cleared {buffer};
+  cleared.clear();
+  TEST("LimbBuffer clear leaves sharer intact", cleared.empty() && buffer.size() == 3);
+  TEST("LimbBuffer equality compares contents", buffer == same && buffer != copy);
+
+  SuperLong original = factorial(100);
+  SuperLong expected = factorial(100);
+  std::vector<SuperLong> copies(9, original);
+  copies[0] += SuperLong {1};
+  copies[1] -= SuperLong {1};
+  copies[2] *= SuperLong {3};
+  copies[3] /= SuperLong {7};
+  copies[4] %= SuperLong {1000003};
+  copies[5] <<= 13;
+  copies[6] >>= 13;
+  ++copies[7];
+  copies[8].negate();
+  TEST("Mutating copies leaves original unchanged", original == expected);
+  TEST("Mutated copies hold new values", copies[0] == expected + SuperLong {1} && copies[5] == (expected << 13) && copies[8] == -expected);
+
+  SuperLong parsed = original;
+  std::string text = "12345";
+  aoi::from_chars(text.data(), text.data() + text.size(), parsed);
+  TEST("Parsing into a copy leaves original unchanged", original == expected && parsed == SuperLong {12345});
+
+  // Copies handed to other threads detach on their own while the original
+  // keeps being mutated here
+  SuperLong shared = factorial(300);
+  SuperLong sharedExpected = factorial(300);
+  std::vector<std::future<SuperLong>> workers;
+  for (int i = 0; i < 4; i++) {
+    workers.push_back(std::async(std::launch::async, [copy = shared, i]() mutable {
+      for (int round = 0; round < 200; round++) {
+        SuperLong again = copy;
+        again += SuperLong {i};
+        copy = again - SuperLong {i};
+      }
+      copy += SuperLong {i};
+      return copy;
+    }));
+  }
+  for (int round = 0; round < 200; round++) {
+    SuperLong again = shared;
+    shared += SuperLong {1};
+    shared = again;
+  }
+  bool threadsAgree = shared == sharedExpected;
+  for (int i = 0; i < 4; i++) {
+    threadsAgree = threadsAgree && workers[i].get() == sharedExpected + SuperLong {i};
+  }
+  TEST("Copies mutated on other threads stay independent", threadsAgree);
+}
+
+// Rational number tests
+void testRational() {
+  std::cout << "\n=== Rational Tests ===" << std::endl;
+
+  SuperRational half {SuperLong {2}, SuperLong {4}};
+  TEST("Rational is not reduced on construction", !half.isNormalized());
+  TEST("Rational reduces when read", half.toString() == "1/2" && half.isNormalized());
+  TEST("Rational moves sign to numerator", SuperRational(SuperLong {3}, SuperLong {-6}).toString() == "-1/2");
+  TEST("Rational parses fraction string", SuperRational("-10/4") == SuperRational(SuperLong {-5}, SuperLong {2}));
+  TEST("Rational parses integer string", SuperRational("42").isInteger() && SuperRational("42").toString() == "42");
+  TEST("Rational parses std::string", SuperRational(std::string {"-10/4"}).toString() == "-5/2");
+
+  SuperRational harmonic;
+  for (int64_t k = 1; k <= 20; k++) {
+    harmonic += SuperRational {SuperLong {1}, SuperLong {k}};
+  }
+  TEST("Rational sums stay unreduced", !harmonic.isNormalized());
+  TEST("Rational harmonic number", harmonic.toString() == "55835135/15519504");
+
+  SuperRational a {SuperLong {6}, SuperLong {35}};
+  SuperRational b {SuperLong {14}, SuperLong {9}};
+  a.normalize();
+  b.normalize();
+  SuperRational product = a * b;
+  TEST("Rational product of normalized operands is normalized", product.isNormalized() && product.toString() == "4/15");
+  SuperRational quotient = a / b;
+  TEST("Rational quotient", quotient.isNormalized() && quotient.toString() == "27/245");
+  TEST("Rational division by negative", (a / -b).toString() == "-27/245");
+  TEST("Rational subtraction", (a - a).isZero() && (b - a).toString() == "436/315");
+  TEST("Rational unreduced product", (SuperRational(SuperLong {2}, SuperLong {4}) * SuperRational(SuperLong {2}, SuperLong {3})).toString() == "1/3");
+  SuperRational crossed = SuperRational(SuperLong {6}, SuperLong {10}) * SuperRational(SuperLong {5}, SuperLong {9});
+  TEST("Rational unreduced product still cross-cancels",
+       !crossed.isNormalized() && crossed == SuperRational(SuperLong {1}, SuperLong {3}) && crossed.toString() == "1/3");
+
+  // Reading an unnormalized value from several threads normalizes it once
+  SuperRational sharedSum;
+  for (int i = 1; i <= 60; i++) {
+    sharedSum += SuperRational(SuperLong {1}, SuperLong {i});
+  }
+  SuperRational sharedExpected = sharedSum;
+  sharedExpected.normalize();
+  std::string expectedText = sharedExpected.toString();
+  std::vector<std::future<bool>> readers;
+  for (int i = 0; i < 4; i++) {
+    readers.push_back(std::async(std::launch::async, [&sharedSum, &sharedExpected, &expectedText, i]() {
+      bool ok = true;
+      for (int round = 0; round < 20; round++) {
+        ok = ok && (i % 2 == 0 ? sharedSum.toString() == expectedText : sharedSum == sharedExpected);
+        ok = ok && (sharedSum * SuperRational(2)).numerator() == sharedExpected.numerator() * SuperLong {2} /
+                                                                     gcd(sharedExpected.denominator(), SuperLong {2});
+      }
+      return ok;
+    }));
+  }
+  bool readersAgree = true;
+  for (std::future<bool>& reader : readers) {
+    readersAgree = reader.get() && readersAgree;
+  }
+  TEST("Rational normalizes safely under concurrent reads", readersAgree && sharedSum.isNormalized());
+
+  SuperRational third {SuperLong {1}, SuperLong {3}};
+  SuperRational twoSixths {SuperLong {2}, SuperLong {6}};
+  TEST("Rational equality across representations", third == twoSixths && !twoSixths.isNormalized());
+  TEST("Rational ordering", SuperRational(SuperLong {-1}, SuperLong {2}) < third && third < SuperRational(SuperLong {1}, SuperLong {2}));
+  TEST("Rational ordering with equal denominators", SuperRational(SuperLong {3}, SuperLong {7}) > SuperRational(SuperLong {2}, SuperLong {7}));
+  TEST("Rational compares with integers", SuperRational(SuperLong {7}, SuperLong {2}) > SuperRational(3) && SuperRational(3) >= SuperRational(SuperLong {6}, SuperLong {2}));
+
+  std::ostringstream out;
+  out << SuperRational(SuperLong {10}, SuperLong {-15});
+  TEST("Rational stream output", out.str() == "-2/3");
+
+  try {
+    SuperRational bad {SuperLong {1}, SuperLong {}};
+    TEST("Rational zero denominator throws exception", false);
+  } catch (const std::invalid_argument&) {
+    TEST("Rational zero denominator throws exception", true);
+  }
+
+  try {
+    static_cast<void>(third / SuperRational {});
+    TEST("Rational division by zero throws exception", false);
+  } catch (const std::invalid_argument&) {
+    TEST("Rational division by zero throws exception", true);
+  }
+}
+
+// Exact 53-bit SuperFloat image of a double
+SuperFloat floatFromDouble(double value) {
+  int exponent = 0;
+  double fraction = std::frexp(value, &exponent);
+  return SuperFloat::fromParts(SuperLong {static_cast<int64_t>(std::ldexp(fraction, 53))}, exponent - 53, 53);
+}
+
+// Binary floating point tests; IEEE doubles serve as a correctly rounded reference
+void testFloat() {
+  std::cout << "\n=== Float Tests ===" << std::endl;
+
+  const double samples[] = {1.0, 3.0, -7.25, 0.1, 1e-30, 12345.6789, -2.5e17, 0.7071067811865476};
+  bool addOk = true;
+  bool subOk = true;
+  bool mulOk = true;
+  bool divOk = true;
+  bool sqrtOk = true;
+  for (double x : samples) {
+    for (double y : samples) {
+      SuperFloat fx = floatFromDouble(x);
+      SuperFloat fy = floatFromDouble(y);
+      addOk = addOk && (fx + fy == floatFromDouble(x + y));
+      subOk = subOk && (fx - fy == floatFromDouble(x - y) || x == y);
+      mulOk = mulOk && (fx * fy == floatFromDouble(x * y));
+      divOk = divOk && (fx / fy == floatFromDouble(x / y));
+    }
+    sqrtOk = sqrtOk && (x < 0 || floatFromDouble(x).sqrt() == floatFromDouble(std::sqrt(x)));
+  }
+  TEST("Float addition rounds like IEEE double", addOk);
+  TEST("Float subtraction rounds like IEEE double", subOk);
+  TEST("Float multiplication rounds like IEEE double", mulOk);
+  TEST("Float division rounds like IEEE double", divOk);
+  TEST("Float square root rounds like IEEE double", sqrtOk);
+
+  TEST("Float tie rounds up to even", SuperFloat::fromParts(SuperLong {11}, 0, 3) == SuperFloat(12, 3));
+  TEST("Float tie rounds down to even", SuperFloat::fromParts(SuperLong {9}, 0, 3) == SuperFloat(8, 3));
+  SuperFloat one {1, 53};
+  SuperFloat tiny = SuperFloat::fromParts(SuperLong {1}, -200, 53);
+  SuperFloat half = SuperFloat::fromParts(SuperLong {1}, -53, 53);
+  TEST("Float far smaller addend is absorbed", one + tiny == one && one - tiny == one);
+  SuperFloat aboveHalf = SuperFloat::fromParts((SuperLong {1} << 200) + (SuperLong {1} << 147) + SuperLong {1}, -200, 201);
+  SuperFloat nextUp = SuperFloat::fromParts(SuperLong {(1LL << 52) + 1}, -52, 53);
+  TEST("Float tie after addition rounds to even", one + half == one);
+  TEST("Float sticky bits break a tie", aboveHalf.withPrecision(53) == nextUp && one + (aboveHalf - one) == aboveHalf);
+  TEST("Float subtraction to zero", (one - one).isZero());
+  TEST("Float comparison", tiny < one && -one < tiny && one >= one && half > tiny);
+  TEST("Float truncates to integer", SuperFloat(floatFromDouble(-7.25)).toSuperLong() == SuperLong {-7});
+  TEST("Float decimal output", floatFromDouble(-7.25).toString(3) == "-7.250" && floatFromDouble(0.1).toString(5) == "0.10000");
+
+  TEST("Float pi", SuperFloat::pi(200).toString(50) == "3.14159265358979323846264338327950288419716939937511");
+  TEST("Float e", SuperFloat::e(200).toString(50) == "2.71828182845904523536028747135266249775724709369996");
+  TEST("Float ln2", SuperFloat::ln2(200).toString(50) == "0.69314718055994530941723212145817656807550013436026");
+  TEST("Float constants respect precision", SuperFloat::pi(64).mantissa().bitLength() <= 64);
+
+  try {
+    static_cast<void>(one / SuperFloat {});
+    TEST("Float division by zero throws exception", false);
+  } catch (const std::invalid_argument&) {
+    TEST("Float division by zero throws exception", true);
+  }
+
+  try {
+    static_cast<void>((-one).sqrt());
+    TEST("Float square root of negative throws exception", false);
+  } catch (const std::invalid_argument&) {
+    TEST("Float square root of negative throws exception", true);
+  }
+}
+
+// Residue number system tests
+void testResidue() {
+  std::cout << "\n=== Residue Tests ===" << std::endl;
+
+  auto basis = std::make_shared<const ResidueBasis>(2048);
+  TEST("Residue basis covers its capacity", basis->modulus().bitLength() > 2049 && basis->size() == basis->primes().size());
+
+  SuperLong a = factorial(150);
+  SuperLong b = SuperLong(0LL) - (factorial(140) + SuperLong {17});
+  ResidueSuperLong ra {basis, a};
+  ResidueSuperLong rb {basis, b};
+  TEST("Residue round trip", ra.toSuperLong() == a && rb.toSuperLong() == b);
+  TEST("Residue addition", (ra + rb).toSuperLong() == a + b);
+  TEST("Residue subtraction", (rb - ra).toSuperLong() == b - a);
+  TEST("Residue multiplication", (ra * rb).toSuperLong() == a * b);
+  TEST("Residue negation", (-ra).toSuperLong() == -a);
+  TEST("Residue equality", ra * rb == rb * ra && ra != rb);
+
+  ResidueSuperLong acc {basis, SuperLong {}};
+  SuperLong expected;
+  for (int64_t k = 1; k <= 50; k++) {
+    acc += ResidueSuperLong {basis, SuperLong {k}} * ra;
+    expected += SuperLong {k} * a;
+  }
+  TEST("Residue accumulation", acc.toSuperLong() == expected);
+  TEST("Residue zero", ResidueSuperLong(basis, SuperLong {}).toSuperLong().isZero());
+
+  auto large = std::make_shared<const ResidueBasis>(40000);
+  SuperLong big = (SuperLong {3} << 19000) + SuperLong {12345};
+  ResidueSuperLong rbig {large, big};
+  TEST("Residue large basis product", (rbig * rbig).toSuperLong() == big * big);
+
+  try {
+    static_cast<void>(ra + rbig);
+    TEST("Residue basis mismatch throws exception", false);
+  } catch (const std::invalid_argument&) {
+    TEST("Residue basis mismatch throws exception", true);
+  }
+}
+
+// Operation trace tests
+void testTrace() {
+  std::cout << "\n=== Trace Tests ===" << std::endl;
+
+  std::string path = (std::filesystem::temp_directory_path() / "superlong_trace_test.bin").string();
+  SuperLong a = factorial(60);
+  SuperLong b = SuperLong {-123456789};
+
+  startTrace(path, true);
+  TEST("Tracing is active after start", isTracing());
+  SuperLong sum = a + b;
+  SuperLong quotient = a / b;
+  std::string text = b.toString();
+  stopTrace();
+  static_cast<void>(a * b);
+  TEST("Tracing is inactive after stop", !isTracing());
+
+  std::vector<TraceRecord> records;
+  {
+    TraceReader reader {path};
+    TraceRecord record {};
+    while (reader.next(record)) {
+      records.push_back(record);
+    }
+  }
+  TEST("Trace skips nested and untraced calls", records.size() == 3);
+  TEST("Trace records operation kinds", records.size() == 3 && records[0].op == TraceOp::Add &&
+                                            records[1].op == TraceOp::Divide && records[2].op == TraceOp::ToString);
+  TEST("Trace records operand sizes", records.size() == 3 && records[1].sizeA == a.serializedSize() - SuperLong::kSerialHeaderSize &&
+                                          records[1].sizeB == 4 && records[2].sizeB == 0);
+  TEST("Trace records operands", records.size() == 3 && records[1].hasOperands && records[1].a == a && records[1].b == b);
+
+  startTrace(path);
+  a *= b;
+  stopTrace();
+  {
+    TraceReader reader {path};
+    TraceRecord record {};
+    TEST("Trace without operands keeps sizes", reader.next(record) && record.op == TraceOp::Multiply && !record.hasOperands && record.sizeB == 4);
+    TEST("Trace ends after last record", !reader.next(record));
+  }
+
+  SuperLong c = (SuperLong {1} << 3000) - SuperLong {3};
+  SuperLong d = (SuperLong {1} << 2000) + SuperLong {7};
+  startTrace(path);
+  SuperLong g = gcd(c, d);
+  SuperLong root = isqrt(c);
+  std::string octal = c.toString(8) + d.toString(7);
+  SuperRational ratio = SuperRational {c, d} * SuperRational {d, c + SuperLong {2}};
+  SuperLong total = g + root;
+  stopTrace();
+  {
+    TraceReader reader {path};
+    TraceRecord record {};
+    size_t count = 0;
+    bool onlyAdds = true;
+    while (reader.next(record)) {
+      count++;
+      onlyAdds = onlyAdds && record.op == TraceOp::Add;
+    }
+    TEST("Trace skips operations inside library functions", count == 2 && onlyAdds);
+  }
+  std::filesystem::remove(path);
+
+  try {
+    TraceReader reader {path};
+    TEST("Reading missing trace throws exception", false);
+  } catch (const std::runtime_error&) {
+    TEST("Reading missing trace throws exception", true);
+  }
+}
+
+// Primality tests
+static bool isPrimeByTrialDivision(int64_t n) {
+  if (n < 2) {
+    return false;
+  }
+  for (int64_t d = 2; d * d <= n; d++) {
+    if (n % d == 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void testPrime() {
+  std::cout << "\n=== Prime Tests ===" << std::endl;
+
+  SuperLong m = (SuperLong {1} << 127) - SuperLong {1};
+  Montgomery ctx {m};
+  SuperLong base = factorial(30);
+  SuperLong exponent = SuperLong {1000003};
+  SuperLong expected {1};
+  for (size_t bit = exponent.bitLength(); bit-- > 0;) {
+    expected = expected * expected % m;
+    if (((exponent >> bit) % SuperLong {2}) == SuperLong {1}) {
+      expected = expected * base % m;
+    }
+  }
+  TEST("Montgomery powMod matches square and multiply", ctx.powMod(base, exponent) == expected);
+  TEST("Montgomery round trip", ctx.fromMontgomery(ctx.toMontgomery(base)) == base % m);
+  TEST("Montgomery reduces negative values", ctx.fromMontgomery(ctx.toMontgomery(SuperLong {-5})) == m - SuperLong {5});
+  TEST("Montgomery Fermat on a Mersenne prime", ctx.powMod(SuperLong {3}, m - SuperLong {1}) == SuperLong {1});
+
+  try {
+    Montgomery even {SuperLong {1000}};
+    TEST("Even Montgomery modulus throws exception", false);
+  } catch (const std::invalid_argument&) {
+    TEST("Even Montgomery modulus throws exception", true);
+  }
+
+  bool smallMatch = true;
+  for (int64_t n = -5; n < 3000; n++) {
+    smallMatch = smallMatch && (is_probable_prime(SuperLong {n}) == isPrimeByTrialDivision(n));
+  }
+  TEST("Small primes match trial division", smallMatch);
+
+  // Crosses the trial division bound, so these go through Baillie-PSW
+  bool boundaryMatch = true;
+  for (int64_t n = 1047000; n < 1050000; n++) {
+    boundaryMatch = boundaryMatch && (is_probable_prime(SuperLong {n}) == isPrimeByTrialDivision(n));
+  }
+  TEST("Primes near the trial division bound match", boundaryMatch);
+
+  TEST("Mersenne 127 is prime", is_probable_prime(m, 5));
+  TEST("Mersenne 521 is prime", is_probable_prime((SuperLong {1} << 521) - SuperLong {1}));
+  TEST("Product of Mersenne primes is composite",
+       !is_probable_prime(((SuperLong {1} << 61) - SuperLong {1}) * ((SuperLong {1} << 89) - SuperLong {1})));
+  // A strong pseudoprime to every prime base up to 23
+  TEST("Strong pseudoprime is rejected", !is_probable_prime(SuperLong {"3825123056546413051"}));
+  TEST("Square of a prime is rejected", !is_probable_prime(SuperLong {1000003} * SuperLong {1000003}));
+
+  TEST("Next prime after 0", next_prime(SuperLong {}) == SuperLong {2});
+  TEST("Next prime after 2", next_prime(SuperLong {2}) == SuperLong {3});
+  TEST("Next prime after 10^10", next_prime(SuperLong {10000000000LL}) == SuperLong {10000000019LL});
+  TEST("Next prime after 10^20", next_prime(SuperLong {"100000000000000000000"}) == SuperLong {"100000000000000000039"});
+  TEST("Next prime after 2^64", next_prime(SuperLong {1} << 64) == (SuperLong {1} << 64) + SuperLong {13});
+  TEST("Next prime reaches a Mersenne prime", next_prime(m - SuperLong {1}) == m);
+
+  try {
+    static_cast<void>(is_probable_prime(m, -1));
+    TEST("Negative round count throws exception", false);
+  } catch (const std::invalid_argument&) {
+    TEST("Negative round count throws exception", true);
+  }
+}
+
+// Random generation tests
+void testRandom() {
+  std::cout << "\n=== Random Tests ===" << std::endl;
+
+  std::mt19937_64 rng {12345};
+  TEST("Random zero bits is zero", random_bits(0, rng).isZero());
+
+  size_t widest = 0;
+  bool withinBits = true;
+  for (int i = 0; i < 200; i++) {
+    SuperLong value = random_bits(100, rng);
+    withinBits = withinBits && !value.isNegative() && value.bitLength() <= 100;
+    widest = std::max(widest, value.bitLength());
+  }
+  TEST("Random bits stay within width", withinBits);
+  TEST("Random bits reach the top bit", widest == 100);
+
+  std::mt19937_64 first {7};
+  std::mt19937_64 second {7};
+  TEST("Random bits are reproducible", random_bits(4096, first) == random_bits(4096, second));
+
+  SuperLong bound = factorial(40);
+  bool belowBound = true;
+  for (int i = 0; i < 200; i++) {
+    SuperLong value = random_below(bound, rng);
+    belowBound = belowBound && !value.isNegative() && value < bound;
+  }
+  TEST("Random below stays in range", belowBound);
+  TEST("Random below one is zero", random_below(SuperLong {1}, rng).isZero());
+
+  std::vector<int> counts(10, 0);
+  for (int i = 0; i < 10000; i++) {
+    counts[static_cast<size_t>(std::stoi(random_below(SuperLong {10}, rng).toString()))]++;
+  }
+  TEST("Random below is roughly uniform", *std::min_element(counts.begin(), counts.end()) > 850 &&
+                                              *std::max_element(counts.begin(), counts.end()) < 1150);
+
+  std::minstd_rand narrow {3};
+  SuperLong fromNarrow = random_bits(77, narrow);
+  TEST("Random bits from a non power-of-two generator", fromNarrow.bitLength() <= 77 && !fromNarrow.isZero());
+
+  std::vector<SuperLong> batch(64);
+  random_bits(batch.data(), batch.size(), 255, rng);
+  bool batchWithin = true;
+  for (const SuperLong& value : batch) {
+    batchWithin = batchWithin && value.bitLength() <= 255;
+  }
+  TEST("Bulk random bits stay within width", batchWithin);
+  TEST("Bulk random bits differ", batch[0] != batch[1] && batch[62] != batch[63]);
+
+  random_below(batch.data(), batch.size(), bound, rng);
+  bool batchBelow = true;
+  for (const SuperLong& value : batch) {
+    batchBelow = batchBelow && value < bound;
+  }
+  TEST("Bulk random below stays in range", batchBelow);
+
+  try {
+    static_cast<void>(random_below(SuperLong {}, rng));
+    TEST("Non-positive random bound throws exception", false);
+  } catch (const std::invalid_argument&) {
+    TEST("Non-positive random bound throws exception", true);
+  }
+}
+
+// Exact division tests
+void testDivExact() {
+  std::cout << "\n=== Exact Division Tests ===" << std::endl;
+
+  std::mt19937_64 rng {46};
+  bool matchesDivision = true;
+  for (int i = 0; i < 100; i++) {
+    SuperLong q = random_bits(8 + 37 * static_cast<size_t>(i), rng) + SuperLong {1};
+    SuperLong b = random_bits(1 + 23 * static_cast<size_t>(i % 17), rng) + SuperLong {1};
+    matchesDivision = matchesDivision && divexact(q * b, b) == q && divexact(q * b, q) == b;
+  }
+  TEST("divexact recovers random factors", matchesDivision);
+
+  SuperLong largeQ = random_bits(20000, rng) + SuperLong {1};
+  SuperLong largeB = (random_bits(12000, rng) << 7) + (SuperLong {1} << 7);
+  TEST("divexact with large divisor and quotient", divexact(largeQ * largeB, largeB) == largeQ && divexact(-(largeQ * largeB), largeQ) == -largeB);
+
+  SuperLong a = factorial(200);
+  SuperLong b = factorial(120);
+  TEST("divexact matches operator/", divexact(a, b) == a / b);
+  TEST("divexact with even divisor", divexact(a, SuperLong {1} << 100) == (a >> 100));
+  TEST("divexact negative dividend", divexact(-a, b) == -(a / b));
+  TEST("divexact negative divisor", divexact(a, -b) == -(a / b));
+  TEST("divexact both negative", divexact(-a, -b) == a / b);
+  TEST("divexact by one", divexact(a, SuperLong {1}) == a && divexact(a, SuperLong {-1}) == -a);
+  TEST("divexact by itself", divexact(b, b) == SuperLong {1});
+  TEST("divexact zero dividend", divexact(SuperLong {}, b).isZero());
+  TEST("divexact small values", divexact(SuperLong {-91}, SuperLong {7}) == SuperLong {-13});
+
+  try {
+    static_cast<void>(divexact(a, SuperLong {}));
+    TEST("divexact by zero throws exception", false);
+  } catch (const std::invalid_argument&) {
+    TEST("divexact by zero throws exception", true);
+  }
+}
+
+// Columnar vector tests
+void testVector() {
+  std::cout << "\n=== Vector Tests ===" << std::endl;
+
+  std::mt19937_64 rng {47};
+  std::vector<SuperLong> reference;
+  SuperLongVector values;
+  for (int i = 0; i < 500; i++) {
+    SuperLong value = random_bits(1 + static_cast<size_t>(i % 90) * 7, rng);
+    if (i % 3 == 0) {
+      value = -value;
+    }
+    reference.push_back(value);
+    values.append(value);
+  }
+  bool stored = values.size() == reference.size();
+  for (size_t i = 0; stored && i < reference.size(); i++) {
+    stored = values[i] == reference[i] && values[i].toSuperLong() == reference[i];
+  }
+  TEST("Vector append and views", stored);
+
+  SuperLongVector others;
+  for (size_t i = 0; i < reference.size(); i++) {
+    others.append(random_bits(40 + i % 300, rng) - random_bits(40 + i % 200, rng));
+  }
+
+  SuperLongVector sums = values;
+  sums.add(others);
+  SuperLongVector differences = values;
+  differences.subtract(others);
+  SuperLongVector products = values;
+  products.multiply(others);
+  bool elementwise = true;
+  for (size_t i = 0; i < reference.size(); i++) {
+    SuperLong other = others[i].toSuperLong();
+    elementwise = elementwise && sums[i] == reference[i] + other && differences[i] == reference[i] - other &&
+                  products[i] == reference[i] * other;
+  }
+  TEST("Vector element-wise add, subtract and multiply", elementwise);
+
+  SuperLongVector scaled = values;
+  SuperLong factor = SuperLong {-1} - factorial(70);
+  scaled.multiply(factor);
+  scaled.add(SuperLong {12345});
+  scaled.subtract(factor);
+  bool scalar = true;
+  for (size_t i = 0; i < reference.size(); i++) {
+    scalar = scalar && scaled[i] == reference[i] * factor + SuperLong {12345} - factor;
+  }
+  TEST("Vector scalar operations", scalar);
+
+  SuperLongVector cancelled = values;
+  cancelled.subtract(values);
+  bool zeros = true;
+  for (size_t i = 0; i < cancelled.size(); i++) {
+    zeros = zeros && cancelled[i].isZero() && !cancelled[i].isNegative();
+  }
+  TEST("Vector self subtraction gives positive zeros", zeros);
+  TEST("Vector compaction reclaims space", cancelled.limbCount() == cancelled.size());
+
+  SuperLongVector doubled = values;
+  doubled.add(doubled);
+  doubled.negate();
+  TEST("Vector aliasing add and negate", doubled[4] == -(reference[4] + reference[4]));
+
+  SuperLongVector sorted = values;
+  sorted.sort();
+  std::vector<SuperLong> expected = reference;
+  std::sort(expected.begin(), expected.end());
+  bool ordered = true;
+  for (size_t i = 0; i < expected.size(); i++) {
+    ordered = ordered && sorted[i] == expected[i];
+  }
+  TEST("Vector sort matches std::sort", ordered);
+  TEST("Vector compare elements", sorted.compare(0, 1) <= 0 && sorted.compare(1, 0) >= 0 && sorted.compare(2, 2) == 0);
+  TEST("Vector equality", values == values && values != sorted);
+
+  values.set(0, factorial(300));
+  values.append(values[0]);
+  TEST("Vector set and append from itself", values[0] == factorial(300) && values[values.size() - 1] == factorial(300));
+
+  try {
+    sums.add(SuperLongVector {});
+    TEST("Vector size mismatch throws exception", false);
+  } catch (const std::invalid_argument&) {
+    TEST("Vector size mismatch throws exception", true);
+  }
+  try {
+    static_cast<void>(values.at(values.size()));
+    TEST("Vector index out of range throws exception", false);
+  } catch (const std::out_of_range&) {
+    TEST("Vector index out of range throws exception", true);
+  }
+}
+
+// Decimal representation tests
+void testDecimal() {
+  std::cout << "\n=== Decimal Tests ===" << std::endl;
+
+  std::string digits = "-1234567890123456789012345678901234567890000000000000000000001";
+  DecimalSuperLong parsed {digits};
+  TEST("Decimal string round trip", parsed.toString() == digits);
+  TEST("Decimal limb count", parsed.size() == 4);
+  TEST("Decimal leading zeros and zero", DecimalSuperLong {"+000123"}.toString() == "123" &&
+                                             DecimalSuperLong {"-0"}.toString() == "0" && !DecimalSuperLong {"-0"}.isNegative());
+  TEST("Decimal int64 extremes", DecimalSuperLong {INT64_MIN}.toString() == "-9223372036854775808" &&
+                                     DecimalSuperLong {INT64_MAX}.toString() == "9223372036854775807");
+
+  std::mt19937_64 rng {49};
+  bool converts = true;
+  for (size_t bits : {1, 63, 64, 65, 512, 513, 4096, 30000, 100000}) {
+    SuperLong value = random_bits(bits, rng) - random_bits(bits / 2 + 1, rng);
+    DecimalSuperLong decimal {value};
+    converts = converts && decimal.toString() == value.toString() && decimal.toSuperLong() == value &&
+               DecimalSuperLong {value.toString()}.toSuperLong() == value;
+  }
+  TEST("Decimal conversions match SuperLong", converts);
+  TEST("Decimal conversion of zero", DecimalSuperLong {SuperLong {}}.isZero() && DecimalSuperLong {}.toSuperLong().isZero());
+  SuperLong power = SuperLong {1} << 20000;
+  TEST("Decimal conversion of a power of two", DecimalSuperLong {power}.toSuperLong() == power);
+
+  bool arithmetic = true;
+  for (size_t bits : {40, 200, 3000, 12000}) {
+    SuperLong a = random_bits(bits, rng) - random_bits(bits, rng);
+    SuperLong b = random_bits(bits * 2 / 3, rng) - random_bits(bits / 2, rng);
+    DecimalSuperLong da {a};
+    DecimalSuperLong db {b};
+    arithmetic = arithmetic && (da + db).toSuperLong() == a + b && (da - db).toSuperLong() == a - b &&
+                 (db - da).toSuperLong() == b - a && (da * db).toSuperLong() == a * b &&
+                 (da * da).toSuperLong() == a * a && (-da).toSuperLong() == -a;
+  }
+  TEST("Decimal arithmetic matches SuperLong", arithmetic);
+
+  DecimalSuperLong nines {"9999999999999999999"};
+  TEST("Decimal carry across limbs", (nines + DecimalSuperLong {1}).toString() == "10000000000000000000" &&
+                                         (DecimalSuperLong {"10000000000000000000"} - DecimalSuperLong {1}) == nines);
+  TEST("Decimal comparisons", DecimalSuperLong {-5} < DecimalSuperLong {3} && nines > DecimalSuperLong {3} &&
+                                  DecimalSuperLong {-7} < DecimalSuperLong {-5} && nines >= nines && nines <= nines);
+
+  try {
+    DecimalSuperLong invalid {"12a4"};
+    TEST("Decimal invalid string throws exception", false);
+  } catch (const std::invalid_argument&) {
+    TEST("Decimal invalid string throws exception", true);
+  }
+}
+
+template <size_t Lanes>
+static bool batchMatchesScalar(size_t bits, std::mt19937_64& rng, BatchKernel kernel) {
+  std::vector<SuperLong> moduli, a, b, exponents;
+  for (size_t l = 0; l < Lanes; l++) {
+    SuperLong m = (random_bits(bits - 2, rng) << 1) + (SuperLong {1} << (bits - 1)) + SuperLong {1};
+    // The first lane keeps every word at its maximum
+    moduli.push_back(l == 0 ? (SuperLong {1} << bits) - SuperLong {1} : m);
+    a.push_back(random_bits(bits + 8, rng) - random_bits(bits, rng));
+    b.push_back(random_bits(bits, rng));
+    exponents.push_back(random_bits(l * 13 % (bits + 1), rng));
+  }
+  MontgomeryBatch<Lanes> batch {moduli};
+  batch.useKernel(kernel);
+  std::vector<SuperLong> products = batch.mulMod(a, b);
+  std::vector<SuperLong> powers = batch.powMod(a, exponents);
+  bool ok = products.size() == Lanes && powers.size() == Lanes;
+  for (size_t l = 0; ok && l < Lanes; l++) {
+    SuperLong expected = (a[l] * b[l]) % moduli[l];
+    if (expected.isNegative()) {
+      expected += moduli[l];
+    }
+    ok = products[l] == expected && powers[l] == batch.context(l).powMod(a[l], exponents[l]);
+  }
+  return ok;
+}
+
+void testBatch() {
+  std::cout << "\n=== Batch Montgomery Tests ===" << std::endl;
+
+  std::mt19937_64 rng {50};
+  const BatchKernel scalar = BatchKernel::Scalar;
+  TEST("Batch of 4 lanes matches Montgomery",
+       batchMatchesScalar<4>(64, rng, scalar) && batchMatchesScalar<4>(1024, rng, scalar));
+  TEST("Batch of 8 lanes matches Montgomery",
+       batchMatchesScalar<8>(32, rng, scalar) && batchMatchesScalar<8>(2048, rng, scalar));
+  TEST("Batch of 16 lanes matches Montgomery",
+       batchMatchesScalar<16>(96, rng, scalar) && batchMatchesScalar<16>(512, rng, scalar));
+
+  // The vector kernels are built into every binary; only the CPU decides
+  // which of them run here
+  const BatchKernel avx2 = BatchKernel::Avx2;
+  if (MontgomeryBatch<4>::supports(avx2)) {
+    TEST("Batch AVX2 kernel matches Montgomery", batchMatchesScalar<4>(64, rng, avx2) &&
+                                                     batchMatchesScalar<8>(2048, rng, avx2) &&
+                                                     batchMatchesScalar<16>(96, rng, avx2));
+  } else {
+    std::cout << "Batch AVX2 kernel - skipped, not supported by this CPU" << std::endl;
+  }
+  const BatchKernel avx512 = BatchKernel::Avx512;
+  if (MontgomeryBatch<8>::supports(avx512)) {
+    TEST("Batch AVX-512 kernel matches Montgomery",
+         batchMatchesScalar<8>(32, rng, avx512) && batchMatchesScalar<16>(512, rng, avx512));
+  } else {
+    std::cout << "Batch AVX-512 kernel - skipped, not supported by this CPU" << std::endl;
+  }
+  TEST("Batch AVX-512 kernel needs 8 lanes", !MontgomeryBatch<4>::supports(avx512));
+  TEST("Batch picks the widest supported kernel",
+       MontgomeryBatch<8>({SuperLong {7}, SuperLong {11}, SuperLong {13}, SuperLong {17}, SuperLong {19},
+                           SuperLong {23}, SuperLong {29}, SuperLong {31}})
+               .kernel() == (MontgomeryBatch<8>::supports(avx512) ? avx512
+                             : MontgomeryBatch<8>::supports(avx2) ? avx2
+                                                                  : scalar));
+
+  std::vector<SuperLong> moduli(4, SuperLong {1000003});
+  MontgomeryBatch<4> batch {moduli};
+  std::vector<SuperLong> ones = batch.fromMontgomery(batch.one());
+  TEST("Batch one converts back to one", ones[0] == SuperLong {1} && ones[3] == SuperLong {1});
+  std::vector<SuperLong> fermat = batch.powMod({SuperLong {2}, SuperLong {3}, SuperLong {-4}, SuperLong {0}}, std::vector<SuperLong>(4, SuperLong {1000002}));
+  TEST("Batch Fermat per lane", fermat[0] == SuperLong {1} && fermat[1] == SuperLong {1} && fermat[2] == SuperLong {1} &&
+                                    fermat[3] == SuperLong {0});
+
+  try {
+    MontgomeryBatch<4> wrong {std::vector<SuperLong>(3, SuperLong {7})};
+    TEST("Batch with wrong lane count throws exception", false);
+  } catch (const std::invalid_argument&) {
+    TEST("Batch with wrong lane count throws exception", true);
+  }
+  try {
+    MontgomeryBatch<4> mixed {{SuperLong {7}, SuperLong {7}, SuperLong {7}, (SuperLong {1} << 40) + SuperLong {1}}};
+    TEST("Batch with mixed word counts throws exception", false);
+  } catch (const std::invalid_argument&) {
+    TEST("Batch with mixed word counts throws exception", true);
+  }
+  try {
+    batch.powMod(moduli, {SuperLong {1}, SuperLong {1}, SuperLong {-1}, SuperLong {1}});
+    TEST("Batch negative exponent throws exception", false);
+  } catch (const std::invalid_argument&) {
+    TEST("Batch negative exponent throws exception", true);
+  }
 }
 
 int main() {
@@ -619,6 +2030,29 @@ int main() {
   testFibonacci();
   testStringParsing();
   testUserDefinedLiteral();
+  testRoots();
+  testGcd();
+  testSerialization();
+  testStreams();
+  testRadix();
+  testFromChars();
+  testHash();
+  testProducts();
+  testAccumulator();
+  testFixedWidth();
+  testAsync();
+  testMapped();
+  testCopyOnWrite();
+  testRational();
+  testFloat();
+  testResidue();
+  testTrace();
+  testPrime();
+  testRandom();
+  testDivExact();
+  testVector();
+  testDecimal();
+  testBatch();
 
   std::cout << std::endl;
   std::cout << "============================================================" << std::endl;
@@ -0,0 +1,90 @@
+#include "superlong-random.hpp"
+#include "superlong-trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace aoi;
+
+// Stand-in for an operand that the trace only recorded the size of: a
+// deterministic value with exactly that many limbs
+static SuperLong synthesize(uint64_t limbs, std::mt19937_64& rng) {
+  size_t topBit = 8 * std::max<uint64_t>(limbs, 1) - 1;
+  return (SuperLong {1} << topBit) + random_bits(topBit, rng);
+}
+
+static double percentile(const std::vector<double>& sorted, double fraction) {
+  size_t index = static_cast<size_t>(fraction * static_cast<double>(sorted.size() - 1) + 0.5);
+  return sorted[index];
+}
+
+// Re-executes every operation of a trace against this build of the library
+// and prints per-operation latency percentiles in microseconds
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "usage: " << argv[0] << " TRACE_FILE" << std::endl;
+    return 1;
+  }
+
+  try {
+    std::map<TraceOp, std::vector<double>> latencies;
+    std::mt19937_64 rng;
+    uint64_t checksum = 0;
+    TraceReader reader {argv[1]};
+    TraceRecord record {};
+    while (reader.next(record)) {
+      SuperLong a = record.hasOperands ? record.a : synthesize(record.sizeA, rng);
+      SuperLong b = record.hasOperands ? record.b : synthesize(record.sizeB, rng);
+      if ((record.op == TraceOp::Divide || record.op == TraceOp::Modulo) && b.isZero()) {
+        continue;
+      }
+
+      auto start = std::chrono::steady_clock::now();
+      switch (record.op) {
+        case TraceOp::Add:
+          checksum += (a + b).hash();
+          break;
+        case TraceOp::Subtract:
+          checksum += (a - b).hash();
+          break;
+        case TraceOp::Multiply:
+          checksum += (a * b).hash();
+          break;
+        case TraceOp::Divide:
+          checksum += (a / b).hash();
+          break;
+        case TraceOp::Modulo:
+          checksum += (a % b).hash();
+          break;
+        case TraceOp::ToString:
+          checksum += a.toString().size();
+          break;
+      }
+      auto elapsed = std::chrono::steady_clock::now() - start;
+      latencies[record.op].push_back(std::chrono::duration<double, std::micro>(elapsed).count());
+    }
+
+    std::cout << std::left << std::setw(10) << "op" << std::right << std::setw(10) << "count" << std::setw(12) << "p50"
+              << std::setw(12) << "p90" << std::setw(12) << "p99" << std::setw(12) << "max" << std::endl;
+    for (auto& [op, samples] : latencies) {
+      std::sort(samples.begin(), samples.end());
+      std::cout << std::left << std::setw(10) << traceOpName(op) << std::right << std::setw(10) << samples.size()
+                << std::fixed << std::setprecision(2) << std::setw(12) << percentile(samples, 0.50) << std::setw(12)
+                << percentile(samples, 0.90) << std::setw(12) << percentile(samples, 0.99) << std::setw(12)
+                << samples.back() << std::endl;
+    }
+    std::cout << "checksum: " << checksum << std::endl;
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << '\n';
+    return 1;
+  }
+  return 0;
+}